@@ -102,6 +102,7 @@
 #define PUSH_CODE_BINARY_RESPONSE       0x8C
 #define PUSH_CODE_PATH_DISCOVERY_RESPONSE 0x8D
 #define PUSH_CODE_CONTROL_DATA          0x8E   // v8+
+#define PUSH_CODE_BULK_RESPONSE         0x8F   // chunk of a response to CMD_SEND_BINARY_REQ, which came as a bulk transfer
 
 #define ERR_CODE_UNSUPPORTED_CMD        1
 #define ERR_CODE_NOT_FOUND              2
@@ -112,6 +113,8 @@
 
 #define MAX_SIGN_DATA_LEN               (8 * 1024) // 8K
 
+#define APP_START_FLAG_FRAMED_STREAM    0x01   // CMD_APP_START, cmd_frame[2]: app can unpack FRAME_STREAM_PACKED writes
+
 void MyMesh::writeOKFrame() {
   uint8_t buf[1];
   buf[0] = RESP_CODE_OK;
@@ -230,7 +233,8 @@ int MyMesh::getInterferenceThreshold() const {
 
 int MyMesh::calcRxDelay(float score, uint32_t air_time) const {
   if (_prefs.rx_delay_base <= 0.0f) return 0;
-  return (int)((pow(_prefs.rx_delay_base, 0.85f - score) - 1.0) * air_time);
+  rx_delay_curve.setBase(_prefs.rx_delay_base);   // (only recomputed if changed)
+  return rx_delay_curve.calc(score, air_time);
 }
 
 uint8_t MyMesh::getExtraAckTransmitCount() const {
@@ -635,8 +639,8 @@ void MyMesh::onControlDataRecv(mesh::Packet *packet) {
   }
   int i = 0;
   out_frame[i++] = PUSH_CODE_CONTROL_DATA;
-  out_frame[i++] = (int8_t)(_radio->getLastSNR() * 4);
-  out_frame[i++] = (int8_t)(_radio->getLastRSSI());
+  out_frame[i++] = packet->_snr;
+  out_frame[i++] = (int8_t)packet->getRSSI();
   out_frame[i++] = packet->path_len;
   memcpy(&out_frame[i], packet->payload, packet->payload_len);
   i += packet->payload_len;
@@ -655,8 +659,8 @@ void MyMesh::onRawDataRecv(mesh::Packet *packet) {
   }
   int i = 0;
   out_frame[i++] = PUSH_CODE_RAW_DATA;
-  out_frame[i++] = (int8_t)(_radio->getLastSNR() * 4);
-  out_frame[i++] = (int8_t)(_radio->getLastRSSI());
+  out_frame[i++] = packet->_snr;
+  out_frame[i++] = (int8_t)packet->getRSSI();
   out_frame[i++] = 0xFF; // reserved (possibly path_len in future)
   memcpy(&out_frame[i], packet->payload, packet->payload_len);
   i += packet->payload_len;
@@ -703,10 +707,58 @@ uint32_t MyMesh::calcDirectTimeoutMillisFor(uint32_t pkt_airtime_millis, uint8_t
 
 void MyMesh::onSendTimeout() {}
 
+uint32_t MyMesh::calcBulkTimeoutMillisFor(int pkt_len, int num_pkts, uint8_t path_len) {
+  return calcDirectTimeoutMillisFor(_radio->getEstAirtimeFor(pkt_len) * num_pkts, path_len);
+}
+
+void MyMesh::onContactMultipartRecv(const ContactInfo &contact, uint8_t type, const uint8_t *secret, const uint8_t *data, size_t len) {
+  if (contact.out_path_len >= 0) {   // bulk transfers are Direct only (need a path for the ACKs)
+    bulk.onMultipartRecv(type, contact.id, secret, contact.out_path, contact.out_path_len, data, len);
+  }
+}
+
+void MyMesh::onBulkRecvComplete(const mesh::Identity& sender, uint16_t xfer_id, const uint8_t* data, size_t len) {
+  // a response to CMD_SEND_BINARY_REQ, too big for one packet:  [tag][response data]
+  uint32_t tag;
+  if (len <= 4) return;
+  memcpy(&tag, data, 4);
+  if (tag != pending_req || !_serial->isConnected()) return;
+
+  pending_req = 0;
+  bulk_push_data = &data[4];   // NOTE: stays valid until next bulk transfer, which needs a new request
+  bulk_push_len = len - 4;
+  bulk_push_ofs = 0;
+  bulk_push_tag = tag;
+}
+
+void MyMesh::writeBulkResponseFrame() {
+  int n = bulk_push_len - bulk_push_ofs;
+  if (n > MAX_FRAME_SIZE - 10) n = MAX_FRAME_SIZE - 10;
+
+  int i = 0;
+  out_frame[i++] = PUSH_CODE_BULK_RESPONSE;
+  out_frame[i++] = 0; // reserved
+  memcpy(&out_frame[i], &bulk_push_tag, 4);   // app needs to match this to RESP_CODE_SENT.tag
+  i += 4;
+  memcpy(&out_frame[i], &bulk_push_ofs, 2);   // offset of this chunk
+  i += 2;
+  memcpy(&out_frame[i], &bulk_push_len, 2);   // total length
+  i += 2;
+  memcpy(&out_frame[i], &bulk_push_data[bulk_push_ofs], n);
+  i += n;
+  _serial->writeFrame(out_frame, i);
+
+  bulk_push_ofs += n;
+  if (bulk_push_ofs >= bulk_push_len) bulk_push_data = NULL;   // all sent
+}
+
 MyMesh::MyMesh(mesh::Radio &radio, mesh::RNG &rng, mesh::RTCClock &rtc, SimpleMeshTables &tables, DataStore& store, AbstractUITask* ui)
     : BaseChatMesh(radio, *new ArduinoMillis(), rng, rtc, *new StaticPoolPacketManager(16), tables),
-      _serial(NULL), telemetry(MAX_PACKET_PAYLOAD - 4), _store(&store), _ui(ui) {
+      _serial(NULL), telemetry(MAX_PACKET_PAYLOAD - 4), rx_delay_curve(0.0f), bulk(*this, *this, bulk_recv_buf), _store(&store), _ui(ui) {
   _iter_started = false;
+  bulk_push_data = NULL;
+  bulk_push_len = bulk_push_ofs = 0;
+  bulk_push_tag = 0;
   _cli_rescue = false;
   offline_queue_len = 0;
   app_target_ver = 0;
@@ -828,12 +880,16 @@ void MyMesh::handleCmdFrame(size_t len) {
     _serial->writeFrame(out_frame, i);
   } else if (cmd_frame[0] == CMD_APP_START &&
              len >= 8) { // sent when app establishes connection, respond with node ID
-    //  cmd_frame[1..7]  reserved future
+    //  cmd_frame[2]  APP_START_FLAG_* bits
+    //  cmd_frame[1], [3..7]  reserved future
     char *app_name = (char *)&cmd_frame[8];
     cmd_frame[len] = 0; // make app_name null terminated
     MESH_DEBUG_PRINTLN("App %s connected", app_name);
 
-    _iter_started = false; // stop any left-over ContactsIterator
+    if (_iter_started) {
+      _iter_started = false; // stop any left-over ContactsIterator
+      _serial->setReplyStream(false);
+    }
     int i = 0;
     out_frame[i++] = RESP_CODE_SELF_INFO;
     out_frame[i++] = ADV_TYPE_CHAT; // what this node Advert identifies as (maybe node's pronouns too?? :-)
@@ -868,6 +924,9 @@ void MyMesh::handleCmdFrame(size_t len) {
     memcpy(&out_frame[i], _prefs.node_name, tlen);
     i += tlen;
     _serial->writeFrame(out_frame, i);
+
+    // NOTE: FRAME_STREAM_PACKED writes are self-describing, so app just needs to handle both forms from here on
+    _serial->setFramedStream((cmd_frame[2] & APP_START_FLAG_FRAMED_STREAM) != 0);
   } else if (cmd_frame[0] == CMD_SEND_TXT_MSG && len >= 14) {
     int i = 1;
     uint8_t txt_type = cmd_frame[i++];
@@ -953,6 +1012,7 @@ void MyMesh::handleCmdFrame(size_t len) {
       _iter = startContactsIterator();
       _iter_started = true;
       _most_recent_lastmod = 0;
+      _serial->setReplyStream(true);   // rest of the contacts go to this client
     }
   } else if (cmd_frame[0] == CMD_SET_ADVERT_NAME && len >= 2) {
     int nlen = len - 1;
@@ -1106,7 +1166,7 @@ void MyMesh::handleCmdFrame(size_t len) {
     } else {
       writeErrFrame(ERR_CODE_ILLEGAL_ARG);
     }
-  } else if (cmd_frame[0] == CMD_SYNC_NEXT_MESSAGE) {
+  } else if (cmd_frame[0] == CMD_SYNC_NEXT_MESSAGE) {   // NOTE: one queue, shared by all connected clients
     int out_len;
     if ((out_len = getFromOfflineQueue(out_frame)) > 0) {
       _serial->writeFrame(out_frame, out_len);
@@ -1758,7 +1818,12 @@ void MyMesh::checkSerialInterface() {
              4); // include the most recent lastmod, so app can update their 'since'
       _serial->writeFrame(out_frame, 5);
       _iter_started = false;
+      _serial->setReplyStream(false);
     }
+  } else if (bulk_push_data               // passing a bulk response to app, one chunk per loop
+             && !_serial->isWriteBusy()
+  ) {
+    writeBulkResponseFrame();
   //} else if (!_serial->isWriteBusy()) {
   //  checkConnections();    // TODO - deprecate the 'Connections' stuff
   }
@@ -1766,6 +1831,7 @@ void MyMesh::checkSerialInterface() {
 
 void MyMesh::loop() {
   BaseChatMesh::loop();
+  bulk.loop();
 
   if (_cli_rescue) {
     checkCLIRescueCmd();
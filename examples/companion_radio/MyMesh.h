@@ -69,6 +69,7 @@
 
 #include <helpers/BaseChatMesh.h>
 #include <helpers/TransportKeyStore.h>
+#include <helpers/BulkTransfer.h>
 
 /* -------------------------------------------------------------------------------------- */
 
@@ -84,7 +85,7 @@ struct AdvertPath {
   uint8_t path[MAX_PATH_SIZE];
 };
 
-class MyMesh : public BaseChatMesh, public DataStoreHost {
+class MyMesh : public BaseChatMesh, public DataStoreHost, public BulkTransferHost {
 public:
   MyMesh(mesh::Radio &radio, mesh::RNG &rng, mesh::RTCClock &rtc, SimpleMeshTables &tables, DataStore& store, AbstractUITask* ui=NULL);
 
@@ -133,6 +134,7 @@ protected:
   uint8_t onContactRequest(const ContactInfo &contact, uint32_t sender_timestamp, const uint8_t *data,
                            uint8_t len, uint8_t *reply) override;
   void onContactResponse(const ContactInfo &contact, const uint8_t *data, uint8_t len) override;
+  void onContactMultipartRecv(const ContactInfo &contact, uint8_t type, const uint8_t *secret, const uint8_t *data, size_t len) override;
   void onControlDataRecv(mesh::Packet *packet) override;
   void onRawDataRecv(mesh::Packet *packet) override;
   void onTraceRecv(mesh::Packet *packet, uint32_t tag, uint32_t auth_code, uint8_t flags,
@@ -148,6 +150,10 @@ protected:
   bool onChannelLoaded(uint8_t channel_idx, const ChannelDetails& ch) override { return setChannel(channel_idx, ch); }
   bool getChannelForSave(uint8_t channel_idx, ChannelDetails& ch) override { return getChannel(channel_idx, ch); }
 
+  // BulkTransferHost methods
+  uint32_t calcBulkTimeoutMillisFor(int pkt_len, int num_pkts, uint8_t path_len) override;
+  void onBulkRecvComplete(const mesh::Identity& sender, uint16_t xfer_id, const uint8_t* data, size_t len) override;
+
   void clearPendingReqs() {
     pending_login = pending_status = pending_telemetry = pending_discovery = pending_req = 0;
   }
@@ -157,6 +163,7 @@ private:
   void writeErrFrame(uint8_t err_code);
   void writeDisabledFrame();
   void writeContactRespFrame(uint8_t code, const ContactInfo &contact);
+  void writeBulkResponseFrame();
   void updateContactFromFrame(ContactInfo &contact, uint32_t& last_mod, const uint8_t *frame, int len);
   void addToOfflineQueue(const uint8_t frame[], int len);
   int getFromOfflineQueue(uint8_t frame[]);
@@ -202,6 +209,12 @@ private:
   uint8_t cmd_frame[MAX_FRAME_SIZE + 1];
   uint8_t out_frame[MAX_FRAME_SIZE + 1];
   CayenneLPP telemetry;
+  mutable mesh::RxDelayCurve rx_delay_curve;
+  BulkTransferManager bulk;
+  uint8_t bulk_recv_buf[BULK_RECV_BUFFER_SIZE];
+  const uint8_t* bulk_push_data;   // bulk response being passed to app, in chunks
+  uint16_t bulk_push_len, bulk_push_ofs;
+  uint32_t bulk_push_tag;
 
   struct Frame {
     uint8_t len;
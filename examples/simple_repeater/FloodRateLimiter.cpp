@@ -0,0 +1,118 @@
+#include "FloodRateLimiter.h"
+#include <Utils.h>
+#include <string.h>
+#include <stdio.h>
+
+static const uint8_t class_burst[FLOOD_NUM_CLASSES] = {
+  FLOOD_RATE_ADVERT_BURST, FLOOD_RATE_GROUP_BURST, FLOOD_RATE_OTHER_BURST
+};
+static const unsigned long class_refill_millis[FLOOD_NUM_CLASSES] = {
+  FLOOD_RATE_ADVERT_REFILL_MILLIS, FLOOD_RATE_GROUP_REFILL_MILLIS, FLOOD_RATE_OTHER_REFILL_MILLIS
+};
+
+void FloodRateLimiter::reset() {
+  memset(sources, 0, sizeof(sources));
+  n_throttled = 0;
+}
+
+void FloodRateLimiter::resetCounters() {
+  for (int i = 0; i < FLOOD_RATE_NUM_SOURCES; i++) {
+    sources[i].n_throttled = 0;
+  }
+  n_throttled = 0;
+}
+
+FloodSource* FloodRateLimiter::findOrEvict(uint8_t kind, uint32_t key, unsigned long now) {
+  int set = ((uint32_t)(key * 2654435761UL) >> 16) & (FLOOD_RATE_NUM_SETS - 1);
+  FloodSource* s = &sources[set * FLOOD_RATE_WAYS];
+
+  FloodSource* lru = NULL;
+  for (int i = 0; i < FLOOD_RATE_WAYS; i++) {
+    if (s[i].kind == kind && s[i].key == key) return &s[i];   // found
+
+    if (s[i].kind == FLOOD_SOURCE_EMPTY) {
+      if (lru == NULL || lru->kind != FLOOD_SOURCE_EMPTY) lru = &s[i];   // prefer empty slots
+    } else if (lru == NULL || (lru->kind != FLOOD_SOURCE_EMPTY && (long)(s[i].last_used - lru->last_used) < 0)) {
+      lru = &s[i];
+    }
+  }
+
+  // (re)initialise, with full buckets
+  lru->key = key;
+  lru->kind = kind;
+  for (int c = 0; c < FLOOD_NUM_CLASSES; c++) {
+    lru->tokens[c] = class_burst[c];
+    lru->refill_at[c] = now;
+  }
+  lru->n_throttled = 0;
+  return lru;
+}
+
+bool FloodRateLimiter::allow(const mesh::Packet* packet, unsigned long now) {
+  uint8_t type = packet->getPayloadType();
+  uint8_t kind;
+  uint32_t key;
+  int c;
+  if (type == PAYLOAD_TYPE_ADVERT) {
+    if (packet->payload_len < 4) return true;
+    kind = FLOOD_SOURCE_PUB_KEY;
+    memcpy(&key, packet->payload, 4);
+    c = FLOOD_CLASS_ADVERT;
+  } else {
+    if (packet->path_len == 0) return true;   // heard from originator itself, no identity to go on
+    kind = FLOOD_SOURCE_PATH;
+    key = packet->path[0];
+    c = (type == PAYLOAD_TYPE_GRP_TXT || type == PAYLOAD_TYPE_GRP_DATA) ? FLOOD_CLASS_GROUP : FLOOD_CLASS_OTHER;
+  }
+
+  FloodSource* s = findOrEvict(kind, key, now);
+  s->last_used = now;
+
+  // credit tokens earned since last refill
+  uint32_t earned = (now - s->refill_at[c]) / class_refill_millis[c];
+  if (earned > 0) {
+    if (s->tokens[c] + earned >= class_burst[c]) {
+      s->tokens[c] = class_burst[c];
+      s->refill_at[c] = now;
+    } else {
+      s->tokens[c] += earned;
+      s->refill_at[c] += earned * class_refill_millis[c];
+    }
+  }
+
+  if (s->tokens[c] == 0) {
+    if (s->n_throttled < 0xFFFF) s->n_throttled++;
+    n_throttled++;
+    return false;
+  }
+  s->tokens[c]--;
+  return true;
+}
+
+void FloodRateLimiter::formatReply(char* reply, int max_len) const {
+  char* dp = reply;
+  dp += sprintf(dp, "total:%d", n_throttled);
+
+  uint32_t below = 0x10000;   // list in descending order of n_throttled
+  while (dp - reply < max_len - 16) {
+    const FloodSource* best = NULL;
+    for (int i = 0; i < FLOOD_RATE_NUM_SOURCES; i++) {
+      const FloodSource* s = &sources[i];
+      if (s->kind != FLOOD_SOURCE_EMPTY && s->n_throttled > 0 && s->n_throttled < below && (best == NULL || s->n_throttled > best->n_throttled)) {
+        best = s;
+      }
+    }
+    if (best == NULL) break;
+
+    // all sources with this same count
+    for (int i = 0; i < FLOOD_RATE_NUM_SOURCES && dp - reply < max_len - 16; i++) {
+      const FloodSource* s = &sources[i];
+      if (s->kind == FLOOD_SOURCE_EMPTY || s->n_throttled != best->n_throttled) continue;
+
+      char hex[10];
+      mesh::Utils::toHex(hex, (const uint8_t *) &s->key, s->kind == FLOOD_SOURCE_PUB_KEY ? 4 : 1);
+      dp += sprintf(dp, "\n%s:%d", hex, (uint32_t)s->n_throttled);
+    }
+    below = best->n_throttled;
+  }
+}
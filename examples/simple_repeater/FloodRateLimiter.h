@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Packet.h>
+
+#ifndef FLOOD_RATE_NUM_SOURCES
+  #define FLOOD_RATE_NUM_SOURCES   32    // total sources tracked (multiple of FLOOD_RATE_WAYS, power of 2)
+#endif
+
+#define FLOOD_RATE_WAYS             4    // sources per hash set, least recently used is evicted
+#define FLOOD_RATE_NUM_SETS        (FLOOD_RATE_NUM_SOURCES / FLOOD_RATE_WAYS)
+
+// per-source budgets, for each class of flood traffic: max burst, and millis to earn back one token
+#ifndef FLOOD_RATE_ADVERT_BURST
+  #define FLOOD_RATE_ADVERT_BURST          3
+#endif
+#ifndef FLOOD_RATE_ADVERT_REFILL_MILLIS
+  #define FLOOD_RATE_ADVERT_REFILL_MILLIS  (10*60*1000UL)
+#endif
+#ifndef FLOOD_RATE_GROUP_BURST
+  #define FLOOD_RATE_GROUP_BURST          20
+#endif
+#ifndef FLOOD_RATE_GROUP_REFILL_MILLIS
+  #define FLOOD_RATE_GROUP_REFILL_MILLIS   (6*1000UL)
+#endif
+#ifndef FLOOD_RATE_OTHER_BURST
+  #define FLOOD_RATE_OTHER_BURST          20
+#endif
+#ifndef FLOOD_RATE_OTHER_REFILL_MILLIS
+  #define FLOOD_RATE_OTHER_REFILL_MILLIS   (4*1000UL)
+#endif
+
+#define FLOOD_CLASS_ADVERT     0
+#define FLOOD_CLASS_GROUP      1    // GRP_TXT, GRP_DATA
+#define FLOOD_CLASS_OTHER      2
+#define FLOOD_NUM_CLASSES      3
+
+#define FLOOD_SOURCE_EMPTY     0
+#define FLOOD_SOURCE_PUB_KEY   1    // key is advert pub_key prefix
+#define FLOOD_SOURCE_PATH      2    // key is first hash in path (first repeater)
+
+struct FloodSource {
+  uint32_t key;
+  uint8_t kind;                                     // FLOOD_SOURCE_*
+  uint8_t tokens[FLOOD_NUM_CLASSES];
+  unsigned long refill_at[FLOOD_NUM_CLASSES];       // millis when tokens were last credited
+  unsigned long last_used;
+  uint16_t n_throttled;
+};
+
+/**
+ * \brief  Per-source token bucket limiter for forwarding of flood packets. Sources are held in a small set-associative
+ *         hash table, so a flood of new sources can only evict entries in its own set.
+ *         Adverts are keyed by their pub_key prefix, so are always limited (including those heard direct from originator).
+ *         Other floods are keyed by first hash in path, so those heard direct from originator (no path) are NOT limited.
+ */
+class FloodRateLimiter {
+  FloodSource sources[FLOOD_RATE_NUM_SOURCES];
+  uint32_t n_throttled;
+
+  FloodSource* findOrEvict(uint8_t kind, uint32_t key, unsigned long now);
+
+public:
+  FloodRateLimiter() { reset(); }
+
+  void reset();
+  void resetCounters();
+
+  /**
+   * \returns  false if packet's source has exhausted its budget for this class of flood traffic
+   */
+  bool allow(const mesh::Packet* packet, unsigned long now);
+
+  uint32_t getNumThrottled() const { return n_throttled; }
+
+  /**
+   * \brief  text list of throttled sources (most throttled first), as 'hex:count' lines
+   */
+  void formatReply(char* reply, int max_len) const;
+};
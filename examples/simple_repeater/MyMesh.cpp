@@ -41,6 +41,19 @@
   #define TXT_ACK_DELAY 200
 #endif
 
+#ifndef GOSSIP_TARGET_RELAYS
+  #define GOSSIP_TARGET_RELAYS      5     // roughly how many of the neighbours should relay each flood packet
+#endif
+#ifndef GOSSIP_MIN_PROB
+  #define GOSSIP_MIN_PROB           0.3f
+#endif
+#define GOSSIP_NEIGHBOUR_MAX_AGE  (60*60)   // seconds, neighbours heard since then are counted for density
+#define GOSSIP_UPDATE_MILLIS      30000
+
+#ifndef FLOOD_SNR_SLOTS_RANGE_DB
+  #define FLOOD_SNR_SLOTS_RANGE_DB  20.0f   // SNR margin (above SF threshold) spread across the flood.slots
+#endif
+
 #define FIRMWARE_VER_LEVEL       1
 
 #define REQ_TYPE_GET_STATUS         0x01 // same as _GET_STATS
@@ -48,6 +61,7 @@
 #define REQ_TYPE_GET_TELEMETRY_DATA 0x03
 #define REQ_TYPE_GET_ACCESS_LIST    0x05
 #define REQ_TYPE_GET_NEIGHBOURS     0x06
+#define REQ_TYPE_GET_STATS_DETAIL   0x07 // needs MESH_STATS build
 
 #define RESP_SERVER_LOGIN_OK        0 // response to ANON_REQ
 
@@ -55,15 +69,17 @@
 
 #define LAZY_CONTACTS_WRITE_DELAY    5000
 
-void MyMesh::putNeighbour(const mesh::Identity &id, uint32_t timestamp, float snr) {
+void MyMesh::putNeighbour(const mesh::Identity &id, uint32_t timestamp, float snr, float rssi) {
 #if MAX_NEIGHBOURS // check if neighbours enabled
   // find existing neighbour, else use least recently updated
   uint32_t oldest_timestamp = 0xFFFFFFFF;
   NeighbourInfo *neighbour = &neighbours[0];
+  bool found = false;
   for (int i = 0; i < MAX_NEIGHBOURS; i++) {
     // if neighbour already known, we should update it
     if (id.matches(neighbours[i].id)) {
       neighbour = &neighbours[i];
+      found = true;
       break;
     }
 
@@ -74,11 +90,88 @@ void MyMesh::putNeighbour(const mesh::Identity &id, uint32_t timestamp, float sn
     }
   }
 
+  if (!found) {
+    if (neighbour->heard_timestamp > 0 && getNeighbourByHash(neighbour->id.pub_key[0]) == neighbour) {
+      neighbour_by_hash[neighbour->id.pub_key[0]] = 0;  // evicted
+    }
+    *neighbour = NeighbourInfo();   // reset link stats
+  }
+
   // update neighbour info
   neighbour->id = id;
   neighbour->advert_timestamp = timestamp;
-  neighbour->heard_timestamp = getRTCClock()->getCurrentTime();
+  neighbour->heard_timestamp = neighbour->link_timestamp = getRTCClock()->getCurrentTime();
   neighbour->snr = (int8_t)(snr * 4);
+  // NOTE: on 1-byte hash collision, most recent advert wins
+  neighbour_by_hash[id.pub_key[0]] = (neighbour - neighbours) + 1;
+
+  updateNeighbourLink(neighbour, snr, rssi);
+#endif
+}
+
+NeighbourInfo* MyMesh::getNeighbourByHash(uint8_t hash) {
+#if MAX_NEIGHBOURS
+  uint8_t idx = neighbour_by_hash[hash];
+  if (idx > 0 && idx <= MAX_NEIGHBOURS) {
+    NeighbourInfo* neighbour = &neighbours[idx - 1];
+    if (neighbour->heard_timestamp > 0 && neighbour->id.pub_key[0] == hash) return neighbour;
+  }
+#endif
+  return NULL;
+}
+
+void MyMesh::updateNeighbourLink(NeighbourInfo* neighbour, float snr, float rssi) {
+  int16_t snr16 = (int16_t)(snr * 16), rssi16 = (int16_t)(rssi * 16);
+  if (neighbour->n_heard == 0 && neighbour->n_missed == 0) {  // first sample
+    neighbour->snr_avg = snr16;
+    neighbour->rssi_avg = rssi16;
+  } else {
+    neighbour->snr_avg += (snr16 - neighbour->snr_avg) >> NEIGHBOUR_EWMA_SHIFT;
+    neighbour->rssi_avg += (rssi16 - neighbour->rssi_avg) >> NEIGHBOUR_EWMA_SHIFT;
+  }
+  neighbour->n_heard++;
+  if (neighbour->n_heard + neighbour->n_missed > NEIGHBOUR_LOSS_WINDOW) {
+    neighbour->n_heard = (neighbour->n_heard + 1) / 2;
+    neighbour->n_missed /= 2;
+  }
+}
+
+static uint32_t calcPayloadKey(const mesh::Packet* pkt) {   // cheap FNV-1a, just to match copies of same flood packet
+  uint32_t h = 2166136261UL ^ pkt->getPayloadType();
+  for (int i = 0; i < pkt->payload_len; i++) {
+    h = (h ^ pkt->payload[i]) * 16777619UL;
+  }
+  return h;
+}
+
+void MyMesh::trackNeighbourRx(const mesh::Packet* pkt) {
+#if MAX_NEIGHBOURS
+  // only flood packets have the sender (last hop) at end of path
+  if (!pkt->isRouteFlood() || pkt->path_len == 0 || pkt->getPayloadType() == PAYLOAD_TYPE_TRACE) return;
+
+  uint32_t key = calcPayloadKey(pkt);
+  uint8_t last_hop = pkt->path[pkt->path_len - 1];
+
+  NeighbourInfo* neighbour = getNeighbourByHash(last_hop);
+  if (neighbour) {   // NOTE: heard_timestamp is only for adverts
+    neighbour->link_timestamp = getRTCClock()->getCurrentTime();
+    updateNeighbourLink(neighbour, pkt->getSNR(), pkt->getRSSI());
+  }
+  recent_rx[next_recent_rx].key = key;
+  recent_rx[next_recent_rx].hop = last_hop;
+  next_recent_rx = (next_recent_rx + 1) % NEIGHBOUR_RECENT_RX;
+
+  // a neighbour was the hop before last, so it transmitted this packet before the last hop did. Did we hear it directly?
+  if (pkt->path_len >= 2) {
+    uint8_t prev_hop = pkt->path[pkt->path_len - 2];
+    neighbour = getNeighbourByHash(prev_hop);
+    if (neighbour) {
+      for (int i = 0; i < NEIGHBOUR_RECENT_RX; i++) {
+        if (recent_rx[i].key == key && recent_rx[i].hop == prev_hop) return;   // yes
+      }
+      neighbour->n_missed++;
+    }
+  }
 #endif
 }
 
@@ -179,6 +272,13 @@ int MyMesh::handleRequest(ClientInfo *sender, uint32_t sender_timestamp, uint8_t
     memcpy(&reply_data[4], telemetry.getBuffer(), tlen);
     return 4 + tlen; // reply_len
   }
+#if MESH_STATS
+  if (payload[0] == REQ_TYPE_GET_STATS_DETAIL && sender->isAdmin()) {
+    uint8_t section = payload[1];   // one of STATS_SECTION_*
+    int len = getDetailStats().writeSection(section, &reply_data[4], sizeof(reply_data) - 4);
+    if (len > 0) return 4 + len;
+  }
+#endif
   if (payload[0] == REQ_TYPE_GET_ACCESS_LIST && sender->isAdmin()) {
     uint8_t res1 = payload[1];   // reserved for future  (extra query params)
     uint8_t res2 = payload[2];
@@ -296,16 +396,6 @@ mesh::Packet *MyMesh::createSelfAdvert() {
   return createAdvert(self_id, app_data, app_data_len);
 }
 
-File MyMesh::openAppend(const char *fname) {
-#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
-  return _fs->open(fname, FILE_O_WRITE);
-#elif defined(RP2040_PLATFORM)
-  return _fs->open(fname, "a");
-#else
-  return _fs->open(fname, "a", true);
-#endif
-}
-
 bool MyMesh::allowPacketForward(const mesh::Packet *packet) {
   if (_prefs.disable_fwd) return false;
   if (packet->isRouteFlood() && packet->path_len >= _prefs.flood_max) return false;
@@ -313,9 +403,54 @@ bool MyMesh::allowPacketForward(const mesh::Packet *packet) {
     MESH_DEBUG_PRINTLN("allowPacketForward: unknown transport code, or wildcard not allowed for FLOOD packet");
     return false;
   }
+  if (packet->isRouteFlood() && _prefs.flood_rate_limit && !flood_limiter.allow(packet, millis())) {
+    MESH_DEBUG_PRINTLN("allowPacketForward: source over its flood budget, not relaying");
+    return false;
+  }
+  if (packet->isRouteFlood() && packet->path_len > 0 && flood_fwd_prob < 1.0f) {   // always relay if heard direct from originator
+    if (getRNG()->nextInt(0, 1000) >= (int)(flood_fwd_prob * 1000)) {
+      MESH_DEBUG_PRINTLN("allowPacketForward: gossip, not relaying (p=%d%%)", (int)(flood_fwd_prob * 100));
+      return false;
+    }
+  }
   return true;
 }
 
+void MyMesh::updateFloodForwardProb() {
+  // observed redundancy, ie. how many dup copies heard per unique flood packet (since last update)
+  uint32_t recv = getNumRecvFlood(), dups = ((SimpleMeshTables *)getTables())->getNumFloodDups();
+  if (recv >= gossip_last_recv && dups >= gossip_last_dups) {   // (stats not cleared since)
+    uint32_t n_dups = dups - gossip_last_dups;
+    uint32_t n_recv = recv - gossip_last_recv;
+    if (n_recv > n_dups) {  // ignore quiet periods
+      float r = (float)n_dups / (float)(n_recv - n_dups);
+      flood_redundancy += (r - flood_redundancy) * 0.25f;   // EWMA
+    }
+  }
+  gossip_last_recv = recv;
+  gossip_last_dups = dups;
+
+  int num_neighbours = 0;
+#if MAX_NEIGHBOURS
+  uint32_t now = getRTCClock()->getCurrentTime();
+  for (int i = 0; i < MAX_NEIGHBOURS; i++) {
+    if (neighbours[i].heard_timestamp > 0 && now - neighbours[i].link_timestamp < GOSSIP_NEIGHBOUR_MAX_AGE) num_neighbours++;
+  }
+#endif
+
+  if (!_prefs.flood_gossip) {
+    flood_fwd_prob = 1.0f;
+#ifdef WITH_BRIDGE
+  } else if (_prefs.bridge_enabled) {
+    flood_fwd_prob = 1.0f;   // bridges must always relay
+#endif
+  } else if (num_neighbours <= GOSSIP_TARGET_RELAYS || flood_redundancy < 1.0f) {
+    flood_fwd_prob = 1.0f;   // sparse area (or edge node), or little redundancy seen: always relay
+  } else {
+    flood_fwd_prob = constrain((float)GOSSIP_TARGET_RELAYS / num_neighbours, GOSSIP_MIN_PROB, 1.0f);
+  }
+}
+
 const char *MyMesh::getLogDateTime() {
   static char tmp[32];
   uint32_t now = getRTCClock()->getCurrentTime();
@@ -342,21 +477,7 @@ void MyMesh::logRx(mesh::Packet *pkt, int len, float score) {
 #endif
 
   if (_logging) {
-    File f = openAppend(PACKET_LOG_FILE);
-    if (f) {
-      f.print(getLogDateTime());
-      f.printf(": RX, len=%d (type=%d, route=%s, payload_len=%d) SNR=%d RSSI=%d score=%d", len,
-               pkt->getPayloadType(), pkt->isRouteDirect() ? "D" : "F", pkt->payload_len,
-               (int)_radio->getLastSNR(), (int)_radio->getLastRSSI(), (int)(score * 1000));
-
-      if (pkt->getPayloadType() == PAYLOAD_TYPE_PATH || pkt->getPayloadType() == PAYLOAD_TYPE_REQ ||
-          pkt->getPayloadType() == PAYLOAD_TYPE_RESPONSE || pkt->getPayloadType() == PAYLOAD_TYPE_TXT_MSG) {
-        f.printf(" [%02X -> %02X]\n", (uint32_t)pkt->payload[1], (uint32_t)pkt->payload[0]);
-      } else {
-        f.printf("\n");
-      }
-      f.close();
-    }
+    packet_log.log(PACKET_LOG_RX, pkt, len, getRTCClock()->getCurrentTime(), pkt->getSNR(), pkt->getRSSI(), score);
   }
 }
 
@@ -368,42 +489,37 @@ void MyMesh::logTx(mesh::Packet *pkt, int len) {
 #endif
 
   if (_logging) {
-    File f = openAppend(PACKET_LOG_FILE);
-    if (f) {
-      f.print(getLogDateTime());
-      f.printf(": TX, len=%d (type=%d, route=%s, payload_len=%d)", len, pkt->getPayloadType(),
-               pkt->isRouteDirect() ? "D" : "F", pkt->payload_len);
-
-      if (pkt->getPayloadType() == PAYLOAD_TYPE_PATH || pkt->getPayloadType() == PAYLOAD_TYPE_REQ ||
-          pkt->getPayloadType() == PAYLOAD_TYPE_RESPONSE || pkt->getPayloadType() == PAYLOAD_TYPE_TXT_MSG) {
-        f.printf(" [%02X -> %02X]\n", (uint32_t)pkt->payload[1], (uint32_t)pkt->payload[0]);
-      } else {
-        f.printf("\n");
-      }
-      f.close();
-    }
+    packet_log.log(PACKET_LOG_TX, pkt, len, getRTCClock()->getCurrentTime(), 0, 0, 0);
   }
 }
 
 void MyMesh::logTxFail(mesh::Packet *pkt, int len) {
   if (_logging) {
-    File f = openAppend(PACKET_LOG_FILE);
-    if (f) {
-      f.print(getLogDateTime());
-      f.printf(": TX FAIL!, len=%d (type=%d, route=%s, payload_len=%d)\n", len, pkt->getPayloadType(),
-               pkt->isRouteDirect() ? "D" : "F", pkt->payload_len);
-      f.close();
-    }
+    packet_log.log(PACKET_LOG_TX_FAIL, pkt, len, getRTCClock()->getCurrentTime(), 0, 0, 0);
   }
 }
 
 int MyMesh::calcRxDelay(float score, uint32_t air_time) const {
   if (_prefs.rx_delay_base <= 0.0f) return 0;
-  return (int)((pow(_prefs.rx_delay_base, 0.85f - score) - 1.0) * air_time);
+  rx_delay_curve.setBase(_prefs.rx_delay_base);   // (only recomputed if changed via CLI)
+  return rx_delay_curve.calc(score, air_time);
 }
 
 uint32_t MyMesh::getRetransmitDelay(const mesh::Packet *packet) {
   uint32_t t = (_radio->getEstAirtimeFor(packet->path_len + packet->payload_len + 2) * _prefs.tx_delay_factor);
+  if (_prefs.flood_snr_slots > 0 && packet->isRouteFlood() && packet->path_len > 0) {  // a flood packet we're relaying
+    // furthest-receiver-first: the weaker we heard it, the more new coverage we likely add, so the earlier our slot.
+    // Nodes with later slots will usually hear our retransmit first, and drop theirs as a dup.
+    // NOTE: floor from the radio's actual SF (prefs may not be applied, eg. temp radio params)
+    float margin = packet->getSNR() - getRadio(packet->_radio_idx)->getSNRFloor();
+    int num_slots = _prefs.flood_snr_slots;
+    int slot = (int)(margin * num_slots / FLOOD_SNR_SLOTS_RANGE_DB);
+    if (slot < 0) slot = 0;
+    if (slot >= num_slots) slot = num_slots - 1;
+
+    uint32_t slot_width = 5*t / num_slots;   // same overall window as the uniform delay
+    return slot*slot_width + getRNG()->nextInt(0, slot_width + 1);   // random within slot, to spread out equal-SNR nodes
+  }
   return getRNG()->nextInt(0, 5*t + 1);
 }
 uint32_t MyMesh::getDirectRetransmitDelay(const mesh::Packet *packet) {
@@ -424,10 +540,39 @@ bool MyMesh::filterRecvFloodPacket(mesh::Packet* pkt) {
   } else {
     recv_pkt_region = NULL;
   }
+  if (_prefs.flood_snr_slots > 0) {
+    cancelQueuedRelay(pkt);   // another node (in an earlier slot) has already relayed this
+  }
+  trackNeighbourRx(pkt);   // link quality, from every copy heard (incl. duplicates)
   // do normal processing
   return false;
 }
 
+bool MyMesh::cancelQueuedRelay(const mesh::Packet* pkt) {
+  uint8_t hash[MAX_HASH_SIZE], queued_hash[MAX_HASH_SIZE];
+  bool hash_calculated = false;
+
+  int n = _mgr->getOutboundCount(0xFFFFFFFF);
+  for (int i = 0; i < n; i++) {
+    auto q = _mgr->getOutboundByIdx(i);
+    // only our own pending relays (on the radio the dup was heard on), ie. flood packets with our hash at end of path
+    if (q->_radio_idx != pkt->_radio_idx || !q->isRouteFlood() || q->path_len < PATH_HASH_SIZE || q->getPayloadType() != pkt->getPayloadType()
+        || !self_id.isHashMatch(&q->path[q->path_len - PATH_HASH_SIZE])) continue;
+
+    if (!hash_calculated) {
+      pkt->calculatePacketHash(hash);
+      hash_calculated = true;
+    }
+    q->calculatePacketHash(queued_hash);
+    if (memcmp(hash, queued_hash, MAX_HASH_SIZE) == 0) {
+      _mgr->free(_mgr->removeOutboundByIdx(i));
+      MESH_DEBUG_PRINTLN("%s cancelled queued relay (dup heard)", getLogDateTime());
+      return true;
+    }
+  }
+  return false;
+}
+
 void MyMesh::onAnonDataRecv(mesh::Packet *packet, const uint8_t *secret, const mesh::Identity &sender,
                             uint8_t *data, size_t len) {
   if (packet->getPayloadType() == PAYLOAD_TYPE_ANON_REQ) { // received an initial request by a possible admin
@@ -494,7 +639,7 @@ void MyMesh::onAdvertRecv(mesh::Packet *packet, const mesh::Identity &id, uint32
   if (packet->path_len == 0 && !isShare(packet)) {
     AdvertDataParser parser(app_data, app_data_len);
     if (parser.isValid() && parser.getType() == ADV_TYPE_REPEATER) { // just keep neigbouring Repeaters
-      putNeighbour(id, timestamp, packet->getSNR());
+      putNeighbour(id, timestamp, packet->getSNR(), packet->getRSSI());
     }
   }
 }
@@ -656,12 +801,13 @@ void MyMesh::onControlDataRecv(mesh::Packet* packet) {
 MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondClock &ms, mesh::RNG &rng,
                mesh::RTCClock &rtc, mesh::MeshTables &tables)
     : mesh::Mesh(radio, ms, rng, rtc, *new StaticPoolPacketManager(32), tables),
-      _cli(board, rtc, sensors, &_prefs, this), telemetry(MAX_PACKET_PAYLOAD - 4), region_map(key_store), temp_map(key_store),
-      discover_limiter(4, 120)  // max 4 every 2 minutes
+      _cli(board, rtc, sensors, &_prefs, this), packet_log(PACKET_LOG_FILE), telemetry(MAX_PACKET_PAYLOAD - 4), region_map(key_store), temp_map(key_store),
+      discover_limiter(4, 120),  // max 4 every 2 minutes
+      rx_delay_curve(0.0f)
 #if defined(WITH_RS232_BRIDGE)
       , bridge(&_prefs, WITH_RS232_BRIDGE, _mgr, &rtc)
 #endif
-#if defined(WITH_ESPNOW_BRIDGE)
+#if defined(WITH_ESPNOW_BRIDGE) || defined(WITH_IP_BRIDGE)
       , bridge(&_prefs, _mgr, &rtc)
 #endif
 {
@@ -672,9 +818,16 @@ MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondCloc
   set_radio_at = revert_radio_at = 0;
   _logging = false;
   region_load_active = false;
+  flood_fwd_prob = 1.0f;
+  flood_redundancy = 0.0f;
+  gossip_last_recv = gossip_last_dups = 0;
+  next_gossip_update = 0;
 
 #if MAX_NEIGHBOURS
   memset(neighbours, 0, sizeof(neighbours));
+  memset(neighbour_by_hash, 0, sizeof(neighbour_by_hash));
+  memset(recent_rx, 0, sizeof(recent_rx));
+  next_recent_rx = 0;
 #endif
 
   // defaults
@@ -718,6 +871,7 @@ void MyMesh::begin(FILESYSTEM *fs) {
   // load persisted prefs
   _cli.loadPrefs(_fs);
   acl.load(_fs);
+  packet_log.begin(_fs);
   // TODO: key_store.begin();
   region_map.load(_fs);
 
@@ -787,19 +941,7 @@ void MyMesh::updateFloodAdvertTimer() {
 }
 
 void MyMesh::dumpLogFile() {
-#if defined(RP2040_PLATFORM)
-  File f = _fs->open(PACKET_LOG_FILE, "r");
-#else
-  File f = _fs->open(PACKET_LOG_FILE);
-#endif
-  if (f) {
-    while (f.available()) {
-      int c = f.read();
-      if (c < 0) break;
-      Serial.print((char)c);
-    }
-    f.close();
-  }
+  packet_log.dumpTo(Serial);
 }
 
 void MyMesh::setTxPower(uint8_t power_dbm) {
@@ -807,6 +949,14 @@ void MyMesh::setTxPower(uint8_t power_dbm) {
 }
 
 void MyMesh::formatNeighborsReply(char *reply) {
+  formatNeighbours(reply, false);
+}
+
+void MyMesh::formatNeighborLinksReply(char *reply) {
+  formatNeighbours(reply, true);
+}
+
+void MyMesh::formatNeighbours(char *reply, bool links) {
   char *dp = reply;
 
 #if MAX_NEIGHBOURS
@@ -837,8 +987,12 @@ void MyMesh::formatNeighborsReply(char *reply) {
     mesh::Utils::toHex(hex, neighbour->id.pub_key, 4);
 
     // add next neighbour
-    uint32_t secs_ago = getRTCClock()->getCurrentTime() - neighbour->heard_timestamp;
-    sprintf(dp, "%s:%d:%d", hex, secs_ago, neighbour->snr);
+    if (links) {   // id, avg SNR (x4), avg RSSI, loss %
+      sprintf(dp, "%s:%d:%d:%d", hex, neighbour->snr_avg / 4, neighbour->rssi_avg / 16, neighbour->getLossPercent());
+    } else {
+      uint32_t secs_ago = getRTCClock()->getCurrentTime() - neighbour->heard_timestamp;
+      sprintf(dp, "%s:%d:%d", hex, secs_ago, neighbour->snr);
+    }
     while (*dp)
       dp++; // find end of string
   }
@@ -850,11 +1004,18 @@ void MyMesh::formatNeighborsReply(char *reply) {
   *dp = 0; // null terminator
 }
 
+void MyMesh::formatThrottledReply(char *reply) {
+  flood_limiter.formatReply(reply, 120);
+}
+
 void MyMesh::removeNeighbor(const uint8_t *pubkey, int key_len) {
 #if MAX_NEIGHBOURS
   for (int i = 0; i < MAX_NEIGHBOURS; i++) {
     NeighbourInfo *neighbour = &neighbours[i];
     if (memcmp(neighbour->id.pub_key, pubkey, key_len) == 0) {
+      if (getNeighbourByHash(neighbour->id.pub_key[0]) == neighbour) {
+        neighbour_by_hash[neighbour->id.pub_key[0]] = 0;
+      }
       neighbours[i] = NeighbourInfo(); // clear neighbour entry
     }
   }
@@ -869,6 +1030,15 @@ void MyMesh::formatRadioStatsReply(char *reply) {
   StatsFormatHelper::formatRadioStats(reply, _radio, radio_driver, getTotalAirTime(), getReceiveAirTime());
 }
 
+bool MyMesh::dumpDetailStats() {
+#if MESH_STATS
+  getDetailStats().printTo(Serial);
+  return true;
+#else
+  return false;
+#endif
+}
+
 void MyMesh::formatPacketStatsReply(char *reply) {
   StatsFormatHelper::formatPacketStats(reply, radio_driver, getNumSentFlood(), getNumSentDirect(), 
                                        getNumRecvFlood(), getNumRecvDirect());
@@ -892,6 +1062,7 @@ void MyMesh::clearStats() {
   radio_driver.resetStats();
   resetStats();
   ((SimpleMeshTables *)getTables())->resetStats();
+  flood_limiter.resetCounters();
 }
 
 void MyMesh::handleCommand(uint32_t sender_timestamp, char *command, char *reply) {
@@ -1090,6 +1261,17 @@ void MyMesh::loop() {
     MESH_DEBUG_PRINTLN("Radio params restored");
   }
 
+  packet_log.loop();   // flush buffered log records, if due
+  if (_logging && packet_log.hasFailed()) {
+    MESH_DEBUG_PRINTLN("Packet log write failed, logging turned off");
+    _logging = false;
+  }
+
+  if (millisHasNowPassed(next_gossip_update)) {
+    updateFloodForwardProb();
+    next_gossip_update = futureMillis(GOSSIP_UPDATE_MILLIS);
+  }
+
   // is pending dirty contacts write needed?
   if (dirty_contacts_expiry && millisHasNowPassed(dirty_contacts_expiry)) {
     acl.save(_fs);
@@ -23,17 +23,24 @@
 #define WITH_BRIDGE
 #endif
 
+#ifdef WITH_IP_BRIDGE
+#include "helpers/bridges/IPBridge.h"
+#define WITH_BRIDGE
+#endif
+
 #include <helpers/AdvertDataHelpers.h>
 #include <helpers/ArduinoHelpers.h>
 #include <helpers/ClientACL.h>
 #include <helpers/CommonCLI.h>
 #include <helpers/IdentityStore.h>
+#include <helpers/PacketLogger.h>
 #include <helpers/SimpleMeshTables.h>
 #include <helpers/StaticPoolPacketManager.h>
 #include <helpers/StatsFormatHelper.h>
 #include <helpers/TxtDataHelpers.h>
 #include <helpers/RegionMap.h>
 #include "RateLimiter.h"
+#include "FloodRateLimiter.h"
 
 #ifdef WITH_BRIDGE
 extern AbstractBridge* bridge;
@@ -65,8 +72,25 @@ struct NeighbourInfo {
   uint32_t advert_timestamp;
   uint32_t heard_timestamp;
   int8_t snr; // multiplied by 4, user should divide to get float value
+  // link quality, from all packets heard directly from this neighbour
+  uint32_t link_timestamp;   // last packet of any kind heard directly (heard_timestamp is adverts only)
+  int16_t snr_avg;      // EWMA, multiplied by 16
+  int16_t rssi_avg;     // EWMA, multiplied by 16
+  uint16_t n_heard;     // packets heard directly
+  uint16_t n_missed;    // packets it relayed, that we only heard second-hand
+
+  int getLossPercent() const {
+    return n_heard + n_missed > 0 ? (n_missed * 100) / (n_heard + n_missed) : 0;
+  }
 };
 
+#ifndef NEIGHBOUR_EWMA_SHIFT
+  #define NEIGHBOUR_EWMA_SHIFT   3    // EWMA weight = 1/8
+#endif
+
+#define NEIGHBOUR_LOSS_WINDOW     128   // halve counts after this many samples, so loss estimate tracks recent conditions
+#define NEIGHBOUR_RECENT_RX        16   // recent (packet, last hop) pairs, for detecting missed transmissions
+
 #ifndef FIRMWARE_BUILD_DATE
   #define FIRMWARE_BUILD_DATE   "13 Nov 2025"
 #endif
@@ -87,6 +111,7 @@ class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   bool _logging;
   NodePrefs _prefs;
   CommonCLI _cli;
+  PacketLogger packet_log;
   uint8_t reply_data[MAX_PACKET_PAYLOAD];
   ClientACL  acl;
   TransportKeyStore key_store;
@@ -94,12 +119,20 @@ class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   RegionEntry* load_stack[8];
   RegionEntry* recv_pkt_region;
   RateLimiter discover_limiter;
+  FloodRateLimiter flood_limiter;
   bool region_load_active;
+  float flood_fwd_prob, flood_redundancy;
+  uint32_t gossip_last_recv, gossip_last_dups;
+  unsigned long next_gossip_update;
   unsigned long dirty_contacts_expiry;
 #if MAX_NEIGHBOURS
   NeighbourInfo neighbours[MAX_NEIGHBOURS];
+  uint8_t neighbour_by_hash[256];   // path hash -> (index into neighbours[]) + 1, or zero
+  struct { uint32_t key; uint8_t hop; } recent_rx[NEIGHBOUR_RECENT_RX];
+  uint8_t next_recent_rx;
 #endif
   CayenneLPP telemetry;
+  mutable mesh::RxDelayCurve rx_delay_curve;
   unsigned long set_radio_at, revert_radio_at;
   float pending_freq;
   float pending_bw;
@@ -110,15 +143,21 @@ class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   RS232Bridge bridge;
 #elif defined(WITH_ESPNOW_BRIDGE)
   ESPNowBridge bridge;
+#elif defined(WITH_IP_BRIDGE)
+  IPBridge bridge;
 #endif
 
-  void putNeighbour(const mesh::Identity& id, uint32_t timestamp, float snr);
+  void putNeighbour(const mesh::Identity& id, uint32_t timestamp, float snr, float rssi);
+  NeighbourInfo* getNeighbourByHash(uint8_t hash);
+  void updateNeighbourLink(NeighbourInfo* neighbour, float snr, float rssi);
+  void trackNeighbourRx(const mesh::Packet* pkt);
+  void formatNeighbours(char *reply, bool links);
+  bool cancelQueuedRelay(const mesh::Packet* pkt);
+  void updateFloodForwardProb();
   uint8_t handleLoginReq(const mesh::Identity& sender, const uint8_t* secret, uint32_t sender_timestamp, const uint8_t* data);
   int handleRequest(ClientInfo* sender, uint32_t sender_timestamp, uint8_t* payload, size_t payload_len);
   mesh::Packet* createSelfAdvert();
 
-  File openAppend(const char* fname);
-
 protected:
   float getAirtimeBudgetFactor() const override {
     return _prefs.airtime_factor;
@@ -185,19 +224,26 @@ public:
   void updateAdvertTimer() override;
   void updateFloodAdvertTimer() override;
 
-  void setLoggingOn(bool enable) override { _logging = enable; }
+  void setLoggingOn(bool enable) override {
+    if (!enable) packet_log.flush();
+    _logging = enable;
+  }
 
   void eraseLogFile() override {
-    _fs->remove(PACKET_LOG_FILE);
+    packet_log.erase();
+    _fs->remove(PACKET_LOG_FILE);   // old text-format log
   }
 
   void dumpLogFile() override;
   void setTxPower(uint8_t power_dbm) override;
   void formatNeighborsReply(char *reply) override;
+  void formatNeighborLinksReply(char *reply) override;
   void removeNeighbor(const uint8_t* pubkey, int key_len) override;
+  void formatThrottledReply(char *reply) override;
   void formatStatsReply(char *reply) override;
   void formatRadioStatsReply(char *reply) override;
   void formatPacketStatsReply(char *reply) override;
+  bool dumpDetailStats() override;
 
   mesh::LocalIdentity& getSelfId() override { return self_id; }
 
@@ -2,7 +2,11 @@
 
 #define REPLY_DELAY_MILLIS          1500
 #define PUSH_NOTIFY_DELAY_MILLIS    2000
-#define SYNC_PUSH_INTERVAL          1200
+#define SYNC_PUSH_INTERVAL          1200   // min gap between pushes to same client
+#define PUSH_TICK_MILLIS            (SYNC_PUSH_INTERVAL / 8)
+
+#define MAX_PUSHES_IN_FLIGHT        8      // awaiting ACK, across all clients
+#define MAX_PUSH_QUEUE_LEN          4      // don't push while this many packets are in outbound queue
 
 #define PUSH_ACK_TIMEOUT_FLOOD      12000
 #define PUSH_TIMEOUT_BASE           4000
@@ -17,6 +21,11 @@
 #define REQ_TYPE_GET_TELEMETRY_DATA 0x03
 #define REQ_TYPE_GET_ACCESS_LIST    0x05
 
+#define SERVER_LOGIN_CAPS           (LOGIN_CAP_MULTI_POST)
+
+// max data for one encrypted TXT_MSG datagram
+#define MAX_PUSH_DATA_LEN   (MAX_PACKET_PAYLOAD - 2*PATH_HASH_SIZE - CIPHER_MAC_SIZE - (CIPHER_BLOCK_SIZE-1))
+
 #define RESP_SERVER_LOGIN_OK        0 // response to ANON_REQ
 
 #define LAZY_CONTACTS_WRITE_DELAY    5000
@@ -40,73 +49,198 @@ struct ServerStats {
 
 void MyMesh::addPost(ClientInfo *client, const char *postData) {
   // TODO: suggested postData format: <title>/<descrption>
+  if (next_post_seq >= MAX_UNSYNCED_POSTS) {   // oldest post is about to be dropped from cyclic queue
+    uint32_t dropped = next_post_seq - MAX_UNSYNCED_POSTS;
+    for (int i = 0; i < acl.getNumClients(); i++) {
+      auto c = acl.getClientByIdx(i);
+      if (c->extra.room.sync_seq <= dropped) {   // not yet synced, client will now need the post_store
+        if (posts[next_post_idx].author.matches(c->id)) c->extra.room.own_since--;
+        c->extra.room.sync_seq = dropped + 1;
+      }
+    }
+  }
+
   posts[next_post_idx].author = client->id; // add to cyclic queue
   StrHelper::strncpy(posts[next_post_idx].text, postData, MAX_POST_TEXT_LEN);
 
   posts[next_post_idx].post_timestamp = getRTCClock()->getCurrentTimeUnique();
+  post_store.append(posts[next_post_idx]);
   next_post_idx = (next_post_idx + 1) % MAX_UNSYNCED_POSTS;
+  next_post_seq++;
+  client->extra.room.own_since++;   // (author's sync_seq is always before this post)
 
   next_push = futureMillis(PUSH_NOTIFY_DELAY_MILLIS);
   _num_posted++; // stats
 }
 
-void MyMesh::pushPostToClient(ClientInfo *client, PostInfo &post) {
-  int len = 0;
-  memcpy(&reply_data[len], &post.post_timestamp, 4);
-  len += 4; // this is a PAST timestamp... but should be accepted by client
+int MyMesh::pushPostsToClient(ClientInfo *client, uint32_t now) {
+  auto room = &client->extra.room;
+  auto push = getPushState(client);
+  // next posts after those already in flight
+  uint32_t since = push->num_pending > 0 ? push->pending[push->num_pending - 1].post_timestamp : room->sync_since;
+  uint32_t seq = room->push_seq;
+
+  // encode posts as: [post_timestamp][prefix of author.pub_key][text_len][text], packing consecutive posts
+  // while they fit (if client accepts multi-post format)
+  int len = 5, count = 0;
+  PostInfo* p;
+  while ((p = findNextPost(client, since, seq, now)) != NULL) {
+    int text_len = strlen(p->text);
+    if (count > 0 && len + 9 + text_len > MAX_PUSH_DATA_LEN) break;
+
+    memcpy(&reply_data[len], &p->post_timestamp, 4); len += 4;
+    memcpy(&reply_data[len], p->author.pub_key, 4); len += 4;   // just first 4 bytes
+    reply_data[len++] = text_len;
+    memcpy(&reply_data[len], p->text, text_len); len += text_len;
+
+    since = p->post_timestamp;
+    if (p != &stored_post) seq++;
+    count++;
+    if ((room->login_caps & LOGIN_CAP_MULTI_POST) == 0) break;
+  }
+  if (count == 0) return 0;
+
+  memcpy(reply_data, &since, 4); // timestamp of (last) post. This is a PAST timestamp... but should be accepted by client
 
   uint8_t attempt;
   getRNG()->random(&attempt, 1); // need this for re-tries, so packet hash (and ACK) will be different
-  reply_data[len++] = (TXT_TYPE_SIGNED_PLAIN << 2) | (attempt & 3); // 'signed' plain text
-
-  // encode prefix of post.author.pub_key
-  memcpy(&reply_data[len], post.author.pub_key, 4);
-  len += 4; // just first 4 bytes
-
-  int text_len = strlen(post.text);
-  memcpy(&reply_data[len], post.text, text_len);
-  len += text_len;
+  if (count == 1) {   // original format: [post_timestamp][flags][author prefix][text]
+    reply_data[4] = (TXT_TYPE_SIGNED_PLAIN << 2) | (attempt & 3); // 'signed' plain text
+    int text_len = reply_data[13];
+    memmove(&reply_data[5], &reply_data[9], 4);
+    memmove(&reply_data[9], &reply_data[14], text_len);
+    len = 9 + text_len;
+  } else {
+    reply_data[4] = (TXT_TYPE_MULTI_POST << 2) | (attempt & 3);
+  }
 
   // calc expected ACK reply
-  mesh::Utils::sha256((uint8_t *)&client->extra.room.pending_ack, 4, reply_data, len, client->id.pub_key, PUB_KEY_SIZE);
-  client->extra.room.push_post_timestamp = post.post_timestamp;
+  uint32_t ack;
+  mesh::Utils::sha256((uint8_t *)&ack, 4, reply_data, len, client->id.pub_key, PUB_KEY_SIZE);
 
   auto reply = createDatagram(PAYLOAD_TYPE_TXT_MSG, client->id, client->shared_secret, reply_data, len);
-  if (reply) {
-    if (client->out_path_len < 0) {
-      sendFlood(reply);
-      client->extra.room.ack_timeout = futureMillis(PUSH_ACK_TIMEOUT_FLOOD);
+  if (reply == NULL) {
+    MESH_DEBUG_PRINTLN("Unable to push post to client");
+    return 0;
+  }
+  if (client->out_path_len < 0) {
+    sendFlood(reply);
+  } else {
+    sendDirect(reply, client->out_path, client->out_path_len);
+  }
+  auto pending = &push->pending[push->num_pending++];   // now in flight, one ACK for all posts
+  pending->ack = ack;
+  pending->post_timestamp = since;
+  pending->sent_at = _ms->getMillis();
+  room->push_seq = seq;
+  push->next_push_at = futureMillis(SYNC_PUSH_INTERVAL);
+  _num_post_pushes++; // stats
+  return count;
+}
+
+unsigned long MyMesh::getPushAckTimeout(const ClientInfo *client, const PushState *push) const {
+  unsigned long timeout;
+  if (client->out_path_len < 0) {
+    timeout = PUSH_ACK_TIMEOUT_FLOOD;
+  } else {
+    timeout = PUSH_TIMEOUT_BASE + PUSH_ACK_TIMEOUT_FACTOR * (client->out_path_len + 1);
+  }
+  // tighten, for clients known to ACK quickly
+  auto rtt = push->ack_rtt;
+  if (rtt > 0 && 2*rtt + PUSH_TIMEOUT_BASE/2 < timeout) {
+    timeout = 2*rtt + PUSH_TIMEOUT_BASE/2;
+  }
+  return timeout;
+}
+
+PostInfo* MyMesh::findNextPost(ClientInfo *client, uint32_t since, uint32_t& seq, uint32_t now) {
+  if (isBehindRecentPosts(since)    // first, any posts from before the cyclic queue
+      && post_store.findNext(since, min(now - POST_SYNC_DELAY_SECS, posts[next_post_idx].post_timestamp - 1), client->id, stored_post)) {
+    return &stored_post;
+  }
+
+  if (seq < getOldestPostSeq()) seq = getOldestPostSeq();
+  while (seq < next_post_seq) {
+    auto p = &posts[seq % MAX_UNSYNCED_POSTS];
+    if (now < p->post_timestamp + POST_SYNC_DELAY_SECS) break;   // too new (and so are all after it)
+    if (!p->author.matches(client->id)) return p;   // don't push posts to the author
+    seq++;
+  }
+  return NULL;
+}
+
+bool MyMesh::isBehindRecentPosts(uint32_t since) const {
+  // oldest in cyclic queue is at next_post_idx (zero if queue not yet full)
+  return since < posts[next_post_idx].post_timestamp;
+}
+
+uint32_t MyMesh::findPostSeq(uint32_t since) const {
+  // posts are in timestamp order, so binary search for first post newer than 'since'
+  uint32_t lo = getOldestPostSeq(), hi = next_post_seq;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (posts[mid % MAX_UNSYNCED_POSTS].post_timestamp <= since) {
+      lo = mid + 1;
     } else {
-      sendDirect(reply, client->out_path, client->out_path_len);
-      client->extra.room.ack_timeout =
-          futureMillis(PUSH_TIMEOUT_BASE + PUSH_ACK_TIMEOUT_FACTOR * (client->out_path_len + 1));
+      hi = mid;
     }
-    _num_post_pushes++; // stats
-  } else {
-    client->extra.room.pending_ack = 0;
-    MESH_DEBUG_PRINTLN("Unable to push post to client");
+  }
+  return lo;
+}
+
+void MyMesh::resetSyncCursor(ClientInfo *client) {
+  auto room = &client->extra.room;
+  room->sync_seq = room->push_seq = findPostSeq(room->sync_since);
+  getPushState(client)->num_pending = 0;
+  room->own_since = 0;
+  for (uint32_t seq = room->sync_seq; seq < next_post_seq; seq++) {
+    if (posts[seq % MAX_UNSYNCED_POSTS].author.matches(client->id)) room->own_since++;
+  }
+}
+
+void MyMesh::advanceSyncCursor(ClientInfo *client, uint32_t timestamp) {
+  auto room = &client->extra.room;
+  room->sync_since = timestamp;
+  while (room->sync_seq < next_post_seq && posts[room->sync_seq % MAX_UNSYNCED_POSTS].post_timestamp <= timestamp) {
+    if (posts[room->sync_seq % MAX_UNSYNCED_POSTS].author.matches(client->id)) room->own_since--;
+    room->sync_seq++;
   }
 }
 
 uint8_t MyMesh::getUnsyncedCount(ClientInfo *client) {
-  uint8_t count = 0;
-  for (int k = 0; k < MAX_UNSYNCED_POSTS; k++) {
-    if (posts[k].post_timestamp > client->extra.room.sync_since // is new post for this Client?
-        && !posts[k].author.matches(client->id)) {   // don't push posts to the author
-      count++;
-    }
+  auto room = &client->extra.room;
+  if (isBehindRecentPosts(room->sync_since)) {   // older posts only in post_store
+    return post_store.countSince(room->sync_since, client->id, MAX_STORE_UNSYNCED_COUNT);
   }
-  return count;
+  uint32_t count = next_post_seq - room->sync_seq - room->own_since;   // don't count posts by this client
+  return count > 255 ? 255 : count;
 }
 
 bool MyMesh::processAck(const uint8_t *data) {
   for (int i = 0; i < acl.getNumClients(); i++) {
     auto client = acl.getClientByIdx(i);
-    if (client->extra.room.pending_ack && memcmp(data, &client->extra.room.pending_ack, 4) == 0) { // got an ACK from Client!
-      client->extra.room.pending_ack = 0; // clear this, so next push can happen
-      client->extra.room.push_failures = 0;
-      client->extra.room.sync_since = client->extra.room.push_post_timestamp; // advance Client's SINCE timestamp, to sync next post
-      return true;
+    auto room = &client->extra.room;
+    auto push = getPushState(client);
+    for (int k = 0; k < push->num_pending; k++) {
+      auto p = &push->pending[k];
+      if (p->ack && memcmp(data, &p->ack, 4) == 0) { // got an ACK from Client!
+        p->ack = 0;
+        unsigned long rtt = _ms->getMillis() - p->sent_at;
+        if (rtt > 0xFFFF) rtt = 0xFFFF;
+        push->ack_rtt = push->ack_rtt ? (push->ack_rtt * 7 + rtt) / 8 : rtt;
+        room->push_failures = 0;
+        if (push->window < ROOM_PUSH_WINDOW) push->window++;   // open up the window
+
+        // advance Client's SINCE timestamp, past all ACKed pushes at front (a gap must wait for its ACK, or timeout)
+        int n = 0;
+        while (n < push->num_pending && push->pending[n].ack == 0) {
+          advanceSyncCursor(client, push->pending[n].post_timestamp);
+          n++;
+        }
+        push->num_pending -= n;
+        memmove(push->pending, &push->pending[n], push->num_pending * sizeof(PendingPush));
+        return true;
+      }
     }
   }
   return false;
@@ -207,7 +341,7 @@ void MyMesh::logRx(mesh::Packet *pkt, int len, float score) {
       f.print(getLogDateTime());
       f.printf(": RX, len=%d (type=%d, route=%s, payload_len=%d) SNR=%d RSSI=%d score=%d", len,
                pkt->getPayloadType(), pkt->isRouteDirect() ? "D" : "F", pkt->payload_len,
-               (int)_radio->getLastSNR(), (int)_radio->getLastRSSI(), (int)(score * 1000));
+               (int)pkt->getSNR(), (int)pkt->getRSSI(), (int)(score * 1000));
 
       if (pkt->getPayloadType() == PAYLOAD_TYPE_PATH || pkt->getPayloadType() == PAYLOAD_TYPE_REQ ||
           pkt->getPayloadType() == PAYLOAD_TYPE_RESPONSE || pkt->getPayloadType() == PAYLOAD_TYPE_TXT_MSG) {
@@ -251,7 +385,8 @@ void MyMesh::logTxFail(mesh::Packet *pkt, int len) {
 
 int MyMesh::calcRxDelay(float score, uint32_t air_time) const {
   if (_prefs.rx_delay_base <= 0.0f) return 0;
-  return (int)((pow(_prefs.rx_delay_base, 0.85f - score) - 1.0) * air_time);
+  rx_delay_curve.setBase(_prefs.rx_delay_base);   // (only recomputed if changed via CLI)
+  return rx_delay_curve.calc(score, air_time);
 }
 
 const char *MyMesh::getLogDateTime() {
@@ -288,6 +423,10 @@ void MyMesh::onAnonDataRecv(mesh::Packet *packet, const uint8_t *secret, const m
 
     data[len] = 0;                                        // ensure null terminator
 
+    uint8_t login_caps = 0;   // optional, after password's null terminator
+    size_t caps_idx = 8 + strlen((char *)&data[8]) + 1;
+    if (caps_idx < len) login_caps = data[caps_idx] & SERVER_LOGIN_CAPS;
+
     ClientInfo* client = NULL;
     if (data[8] == 0) {   // blank password, just check if sender is in ACL
       client = acl.getClient(sender.pub_key, PUB_KEY_SIZE);
@@ -321,8 +460,11 @@ void MyMesh::onAnonDataRecv(mesh::Packet *packet, const uint8_t *secret, const m
       MESH_DEBUG_PRINTLN("Login success!");
       client->last_timestamp = sender_timestamp;
       client->extra.room.sync_since = sender_sync_since;
-      client->extra.room.pending_ack = 0;
+      memset(getPushState(client), 0, sizeof(PushState));   // (slot may have been evicted from another client)
+      getPushState(client)->window = 1;
+      resetSyncCursor(client);
       client->extra.room.push_failures = 0;
+      client->extra.room.login_caps = login_caps;
 
       client->last_activity = getRTCClock()->getCurrentTime();
       client->permissions &= ~0x03;
@@ -342,16 +484,20 @@ void MyMesh::onAnonDataRecv(mesh::Packet *packet, const uint8_t *secret, const m
     reply_data[7] = client->permissions; // NEW
     getRNG()->random(&reply_data[8], 4);   // random blob to help packet-hash uniqueness
     reply_data[12] = FIRMWARE_VER_LEVEL;  // New field
+    int reply_len = 13;
+    if (client->extra.room.login_caps) {
+      reply_data[reply_len++] = client->extra.room.login_caps;   // accepted caps (only if client asked)
+    }
 
     next_push = futureMillis(PUSH_NOTIFY_DELAY_MILLIS); // delay next push, give RESPONSE packet time to arrive first
 
     if (packet->isRouteFlood()) {
       // let this sender know path TO here, so they can use sendDirect(), and ALSO encode the response
       mesh::Packet *path = createPathReturn(sender, client->shared_secret, packet->path, packet->path_len,
-                                            PAYLOAD_TYPE_RESPONSE, reply_data, 13);
+                                            PAYLOAD_TYPE_RESPONSE, reply_data, reply_len);
       if (path) sendFlood(path, SERVER_RESPONSE_DELAY);
     } else {
-      mesh::Packet *reply = createDatagram(PAYLOAD_TYPE_RESPONSE, sender, client->shared_secret, reply_data, 13);
+      mesh::Packet *reply = createDatagram(PAYLOAD_TYPE_RESPONSE, sender, client->shared_secret, reply_data, reply_len);
       if (reply) {
         if (client->out_path_len >= 0) { // we have an out_path, so send DIRECT
           sendDirect(reply, client->out_path, client->out_path_len, SERVER_RESPONSE_DELAY);
@@ -510,8 +656,7 @@ void MyMesh::onPeerDataRecv(mesh::Packet *packet, uint8_t type, int sender_idx,
         if (forceSince > 0) {
           client->extra.room.sync_since = forceSince; // force-update the 'sync since'
         }
-
-        client->extra.room.pending_ack = 0;
+        resetSyncCursor(client);   // re-push from sync_since
 
         // TODO: Throttle KEEP_ALIVE requests!
         // if client sends too quickly, evict()
@@ -583,13 +728,14 @@ void MyMesh::onAckRecv(mesh::Packet *packet, uint32_t ack_crc) {
 MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondClock &ms, mesh::RNG &rng,
                mesh::RTCClock &rtc, mesh::MeshTables &tables)
     : mesh::Mesh(radio, ms, rng, rtc, *new StaticPoolPacketManager(32), tables),
-      _cli(board, rtc, sensors, &_prefs, this), telemetry(MAX_PACKET_PAYLOAD - 4) {
+      _cli(board, rtc, sensors, &_prefs, this), post_store(POST_STORE_FILE), telemetry(MAX_PACKET_PAYLOAD - 4), rx_delay_curve(0.0f) {
   last_millis = 0;
   uptime_millis = 0;
   next_local_advert = next_flood_advert = 0;
   dirty_contacts_expiry = 0;
   _logging = false;
   set_radio_at = revert_radio_at = 0;
+  memset(push_state, 0, sizeof(push_state));
 
   // defaults
   memset(&_prefs, 0, sizeof(_prefs));
@@ -621,6 +767,7 @@ MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondCloc
   _prefs.advert_loc_policy = ADVERT_LOC_PREFS;
 
   next_post_idx = 0;
+  next_post_seq = 0;
   next_client_idx = 0;
   next_push = 0;
   memset(posts, 0, sizeof(posts));
@@ -635,6 +782,13 @@ void MyMesh::begin(FILESYSTEM *fs) {
 
   acl.load(_fs);
 
+  int n = post_store.begin(_fs, posts, MAX_UNSYNCED_POSTS);
+  next_post_idx = n % MAX_UNSYNCED_POSTS;
+  next_post_seq = n;
+  for (int i = 0; i < acl.getNumClients(); i++) {
+    resetSyncCursor(acl.getClientByIdx(i));
+  }
+
   radio_set_params(_prefs.freq, _prefs.bw, _prefs.sf, _prefs.cr);
   radio_set_tx_power(_prefs.tx_power_dbm);
 
@@ -769,7 +923,15 @@ void MyMesh::handleCommand(uint32_t sender_timestamp, char *command, char *reply
       int hex_len = min(sp - hex, PUB_KEY_SIZE*2);
       if (mesh::Utils::fromHex(pubkey, hex_len / 2, hex)) {
         uint8_t perms = atoi(sp);
+        auto c = acl.getClient(pubkey, hex_len / 2);
+        int idx = c ? c - acl.getClientByIdx(0) : -1;
         if (acl.applyPermissions(self_id, pubkey, hex_len / 2, perms)) {
+          // keep push_state[] parallel to the ACL slots
+          if ((perms & PERM_ACL_ROLE_MASK) == PERM_ACL_GUEST) {   // removed, later slots shifted down
+            memmove(&push_state[idx], &push_state[idx + 1], (acl.getNumClients() - idx) * sizeof(PushState));
+          } else if (idx < 0) {   // newly added (possibly into an evicted slot)
+            memset(getPushState(acl.getClient(pubkey, PUB_KEY_SIZE)), 0, sizeof(PushState));
+          }
           dirty_contacts_expiry = futureMillis(LAZY_CONTACTS_WRITE_DELAY);   // trigger acl.save()
           strcpy(reply, "OK");
         } else {
@@ -802,47 +964,47 @@ bool MyMesh::saveFilter(ClientInfo* client) {
 void MyMesh::loop() {
   mesh::Mesh::loop();
 
+  post_store.loop(getRTCClock()->getCurrentTime());
+
   if (millisHasNowPassed(next_push) && acl.getNumClients() > 0) {
-    // check for ACK timeouts
+    // check for ACK timeouts, of oldest push in flight
+    int in_flight = 0;
     for (int i = 0; i < acl.getNumClients(); i++) {
-      auto c = acl.getClientByIdx(i);
-      if (c->extra.room.pending_ack && millisHasNowPassed(c->extra.room.ack_timeout)) {
-        c->extra.room.push_failures++;
-        c->extra.room.pending_ack = 0; // reset  (TODO: keep prev expected_ack's in a list, incase they arrive LATER, after we retry)
-        MESH_DEBUG_PRINTLN("pending ACK timed out: push_failures: %d", (uint32_t)c->extra.room.push_failures);
-      }
-    }
-    // check next Round-Robin client, and sync next new post
-    auto client = acl.getClientByIdx(next_client_idx);
-    bool did_push = false;
-    if (client->extra.room.pending_ack == 0 && client->last_activity != 0 &&
-        client->extra.room.push_failures < 3) { // not already waiting for ACK, AND not evicted, AND retries not max
-      MESH_DEBUG_PRINTLN("loop - checking for client %02X", (uint32_t)client->id.pub_key[0]);
-      uint32_t now = getRTCClock()->getCurrentTime();
-      for (int k = 0, idx = next_post_idx; k < MAX_UNSYNCED_POSTS; k++) {
-        auto p = &posts[idx];
-        if (now >= p->post_timestamp + POST_SYNC_DELAY_SECS &&
-            p->post_timestamp > client->extra.room.sync_since // is new post for this Client?
-            && !p->author.matches(client->id)) {   // don't push posts to the author
-          // push this post to Client, then wait for ACK
-          pushPostToClient(client, *p);
-          did_push = true;
-          MESH_DEBUG_PRINTLN("loop - pushed to client %02X: %s", (uint32_t)client->id.pub_key[0], p->text);
-          break;
-        }
-        idx = (idx + 1) % MAX_UNSYNCED_POSTS; // wrap to start of cyclic queue
+      auto client = acl.getClientByIdx(i);
+      auto room = &client->extra.room;
+      auto push = &push_state[i];
+      if (push->num_pending > 0 && millisHasNowPassed(push->pending[0].sent_at + getPushAckTimeout(client, push))) {
+        room->push_failures++;
+        push->num_pending = 0; // go back, and re-push from sync_since  (TODO: keep prev expected_ack's in a list, incase they arrive LATER, after we retry)
+        room->push_seq = room->sync_seq;
+        push->window = push->window > 1 ? push->window / 2 : 1;
+        push->next_push_at = futureMillis(SYNC_PUSH_INTERVAL << room->push_failures);   // back-off
+        MESH_DEBUG_PRINTLN("pending ACK timed out: push_failures: %d", (uint32_t)room->push_failures);
       }
-    } else {
-      MESH_DEBUG_PRINTLN("loop - skipping busy (or evicted) client %02X", (uint32_t)client->id.pub_key[0]);
+      in_flight += push->num_pending;
     }
-    next_client_idx = (next_client_idx + 1) % acl.getNumClients(); // round robin polling for each client
 
-    if (did_push) {
-      next_push = futureMillis(SYNC_PUSH_INTERVAL);
-    } else {
-      // were no unsynced posts for curr client, so proccess next client much quicker! (in next loop())
-      next_push = futureMillis(SYNC_PUSH_INTERVAL / 8);
+    // round-robin, push next post to each client with room in its window, while outbound queue isn't backed up
+    // and airtime budget allows
+    uint32_t now = getRTCClock()->getCurrentTime();
+    int num_clients = acl.getNumClients();
+    for (int n = 0; n < num_clients && in_flight < MAX_PUSHES_IN_FLIGHT; n++) {
+      if (_mgr->getOutboundCount(0xFFFFFFFF) >= MAX_PUSH_QUEUE_LEN || !isTxBudgetAvailable()) break;
+
+      auto client = acl.getClientByIdx(next_client_idx);
+      next_client_idx = (next_client_idx + 1) % num_clients;
+
+      auto push = getPushState(client);
+      if (client->last_activity == 0 || client->extra.room.push_failures >= 3) continue;  // evicted, or retries maxed
+      if (push->num_pending >= (push->window ? push->window : 1) || !millisHasNowPassed(push->next_push_at)) continue;
+
+      int n_posts = pushPostsToClient(client, now);
+      if (n_posts > 0) {
+        in_flight++;
+        MESH_DEBUG_PRINTLN("loop - pushed %d post(s) to client %02X (%d in flight)", n_posts, (uint32_t)client->id.pub_key[0], (uint32_t)push->num_pending);
+      }
     }
+    next_push = futureMillis(PUSH_TICK_MILLIS);
   }
 
   if (next_flood_advert && millisHasNowPassed(next_flood_advert)) {
@@ -22,6 +22,7 @@
 #include <helpers/ClientACL.h>
 #include <RTClib.h>
 #include <target.h>
+#include "PostStore.h"
 
 /* ------------------------------ Config -------------------------------- */
 
@@ -67,6 +68,10 @@
   #define MAX_UNSYNCED_POSTS    32
 #endif
 
+#ifndef MAX_STORE_UNSYNCED_COUNT
+  #define MAX_STORE_UNSYNCED_COUNT   64   // unsynced count reported from post_store is capped at this (bounds records read)
+#endif
+
 #ifndef SERVER_RESPONSE_DELAY
   #define SERVER_RESPONSE_DELAY   300
 #endif
@@ -78,13 +83,24 @@
 #define FIRMWARE_ROLE "room_server"
 
 #define PACKET_LOG_FILE  "/packet_log"
+#define POST_STORE_FILE  "/posts"
 
-#define MAX_POST_TEXT_LEN    (160-9)
+#ifndef ROOM_PUSH_WINDOW
+  #define ROOM_PUSH_WINDOW      4    // max posts in flight (awaiting ACK) per client
+#endif
+
+struct PendingPush {
+  uint32_t ack;              // expected ACK, or zero once ACKed
+  uint32_t post_timestamp;
+  unsigned long sent_at;     // millis
+};
 
-struct PostInfo {
-  mesh::Identity author;
-  uint32_t post_timestamp;   // by OUR clock
-  char text[MAX_POST_TEXT_LEN+1];
+struct PushState {           // per client, kept here (not in ClientInfo) so other ClientACL users don't pay for it
+  PendingPush pending[ROOM_PUSH_WINDOW];   // pushes in flight, oldest first
+  unsigned long next_push_at;  // earliest millis for next push (pacing, and back-off after failures)
+  uint16_t ack_rtt;      // smoothed millis from push to ACK (zero if not known)
+  uint8_t  num_pending;
+  uint8_t  window;       // current limit on num_pending (congestion window)
 };
 
 class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
@@ -96,14 +112,19 @@ class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   NodePrefs _prefs;
   CommonCLI _cli;
   ClientACL acl;
+  PushState push_state[MAX_CLIENTS];   // parallel to ACL slots, ie. push_state[i] is for acl.getClientByIdx(i)
   unsigned long dirty_contacts_expiry;
   uint8_t reply_data[MAX_PACKET_PAYLOAD];
   unsigned long next_push;
   uint16_t _num_posted, _num_post_pushes;
   int next_client_idx;  // for round-robin polling
   int next_post_idx;
-  PostInfo posts[MAX_UNSYNCED_POSTS];   // cyclic queue
+  uint32_t next_post_seq;  // sequence number of next post (post 'seq' is in posts[seq % MAX_UNSYNCED_POSTS])
+  PostInfo posts[MAX_UNSYNCED_POSTS];   // cyclic queue, of most recent posts
+  PostStore post_store;                 // all retained posts, for clients further behind
+  PostInfo stored_post;                 // last read from post_store
   CayenneLPP telemetry;
+  mutable mesh::RxDelayCurve rx_delay_curve;
   unsigned long set_radio_at, revert_radio_at;
   float pending_freq;
   float pending_bw;
@@ -112,8 +133,16 @@ class MyMesh : public mesh::Mesh, public CommonCLICallbacks {
   int  matching_peer_indexes[MAX_CLIENTS];
 
   void addPost(ClientInfo* client, const char* postData);
-  void pushPostToClient(ClientInfo* client, PostInfo& post);
+  int pushPostsToClient(ClientInfo* client, uint32_t now);
+  PushState* getPushState(const ClientInfo* client) { return &push_state[client - acl.getClientByIdx(0)]; }
+  unsigned long getPushAckTimeout(const ClientInfo* client, const PushState* push) const;
+  PostInfo* findNextPost(ClientInfo* client, uint32_t since, uint32_t& seq, uint32_t now);
   uint8_t getUnsyncedCount(ClientInfo* client);
+  bool isBehindRecentPosts(uint32_t since) const;
+  uint32_t getOldestPostSeq() const { return next_post_seq > MAX_UNSYNCED_POSTS ? next_post_seq - MAX_UNSYNCED_POSTS : 0; }
+  uint32_t findPostSeq(uint32_t since) const;
+  void resetSyncCursor(ClientInfo* client);
+  void advanceSyncCursor(ClientInfo* client, uint32_t timestamp);
   bool processAck(const uint8_t *data);
   mesh::Packet* createSelfAdvert();
   File openAppend(const char* fname);
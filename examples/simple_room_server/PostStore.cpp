@@ -0,0 +1,363 @@
+#include "PostStore.h"
+
+#define COMPACT_IDLE   0
+#define COMPACT_SKIP   1    // dropping oldest records
+#define COMPACT_COPY   2    // copying kept records to temp file
+
+static File openRead(FILESYSTEM* _fs, const char* filename) {
+#if defined(RP2040_PLATFORM)
+  return _fs->open(filename, "r");
+#else
+  return _fs->open(filename);
+#endif
+}
+
+static File openWrite(FILESYSTEM* _fs, const char* filename) {
+#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+  _fs->remove(filename);
+  return _fs->open(filename, FILE_O_WRITE);
+#elif defined(RP2040_PLATFORM)
+  return _fs->open(filename, "w");
+#else
+  return _fs->open(filename, "w", true);
+#endif
+}
+
+static File openAppend(FILESYSTEM* _fs, const char* filename) {
+#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+  return _fs->open(filename, FILE_O_WRITE);
+#elif defined(RP2040_PLATFORM)
+  return _fs->open(filename, "a");
+#else
+  return _fs->open(filename, "a", true);
+#endif
+}
+
+// returns length of record, or zero if at end of file (or corrupt)
+static int readRecord(File& f, uint8_t rec[]) {
+  if (f.read(rec, POST_RECORD_HEADER_SIZE) != POST_RECORD_HEADER_SIZE) return 0;
+
+  int text_len = rec[POST_RECORD_HEADER_SIZE - 1];
+  if (text_len > MAX_POST_TEXT_LEN) return 0;
+  if (text_len > 0 && f.read(&rec[POST_RECORD_HEADER_SIZE], text_len) != text_len) return 0;
+
+  return POST_RECORD_HEADER_SIZE + text_len;
+}
+
+static uint32_t recordTimestamp(const uint8_t rec[]) {
+  uint32_t timestamp;
+  memcpy(&timestamp, rec, 4);
+  return timestamp;
+}
+
+static void parseRecord(const uint8_t rec[], PostInfo& dest) {
+  memcpy(&dest.post_timestamp, rec, 4);
+  memcpy(dest.author.pub_key, &rec[4], PUB_KEY_SIZE);
+  int text_len = rec[POST_RECORD_HEADER_SIZE - 1];
+  memcpy(dest.text, &rec[POST_RECORD_HEADER_SIZE], text_len);
+  dest.text[text_len] = 0;
+}
+
+PostStore::PostStore(const char* filename) : _fs(NULL), _filename(filename) {
+  sprintf(_tmp_name, "%s.tmp", filename);
+  num_index = 0;
+  index_interval = POST_STORE_INDEX_INTERVAL;
+  since_checkpoint = 0;
+  num_posts = num_bytes = 0;
+  oldest_timestamp = 0;
+  next_compact_check = 0;
+  needs_repair = false;
+  compact_state = COMPACT_IDLE;
+}
+
+void PostStore::addCheckpoint(uint32_t timestamp, uint32_t offset) {
+  if (num_index == 0 || since_checkpoint >= index_interval) {
+    if (num_index >= POST_STORE_MAX_CHECKPOINTS) {   // index is full, keep every other checkpoint
+      for (int i = 0; i < num_index / 2; i++) {
+        index[i] = index[i * 2];
+      }
+      num_index /= 2;
+      index_interval *= 2;
+    }
+    index[num_index].timestamp = timestamp;
+    index[num_index].offset = offset;
+    num_index++;
+    since_checkpoint = 0;
+  }
+  since_checkpoint++;
+}
+
+uint32_t PostStore::findStart(uint32_t since) const {
+  // binary search for last checkpoint at or before 'since'
+  int lo = 0, hi = num_index;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (index[mid].timestamp <= since) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo > 0 ? index[lo - 1].offset : 0;
+}
+
+int PostStore::begin(FILESYSTEM* fs, PostInfo recent[], int max_recent) {
+  _fs = fs;
+  num_index = 0;
+  index_interval = POST_STORE_INDEX_INTERVAL;
+  since_checkpoint = 0;
+  num_posts = num_bytes = 0;
+  oldest_timestamp = 0;
+  needs_repair = false;
+  compact_state = COMPACT_IDLE;
+  if (_fs->exists(_filename)) {
+    _fs->remove(_tmp_name);   // from an interrupted compaction (log is still intact)
+  } else if (_fs->exists(_tmp_name)) {
+    // power lost in finishCompaction(), between remove and rename. Temp file is the complete, compacted log
+    MESH_DEBUG_PRINTLN("PostStore: recovering compacted log");
+    _fs->rename(_tmp_name, _filename);
+  }
+
+  if (!_fs->exists(_filename)) return 0;
+
+  File f = openRead(_fs, _filename);
+  if (!f) return 0;
+
+  uint8_t rec[POST_RECORD_MAX_SIZE];
+  int len;
+  while ((len = readRecord(f, rec)) > 0) {
+    PostInfo& post = recent[num_posts % max_recent];
+    parseRecord(rec, post);
+    if (num_posts == 0) oldest_timestamp = post.post_timestamp;
+
+    addCheckpoint(post.post_timestamp, num_bytes);
+    num_posts++;
+    num_bytes += len;
+  }
+  uint32_t file_size = f.size();
+  f.close();
+
+  if (file_size > num_bytes) {   // last record was cut short (eg. power lost mid-write)
+    MESH_DEBUG_PRINTLN("PostStore: dropping %d trailing bytes", file_size - num_bytes);
+    needs_repair = true;   // rewritten from loop()
+  }
+  MESH_DEBUG_PRINTLN("PostStore: loaded %d posts, %d bytes", num_posts, num_bytes);
+  return num_posts;
+}
+
+void PostStore::startRepair() {
+  // rewrite all whole records, same as a compaction that drops none
+  MESH_DEBUG_PRINTLN("PostStore: repairing, posts=%d, bytes=%d", num_posts, num_bytes);
+  compact_pos = compact_dropped = 0;
+  startCopy(oldest_timestamp);
+}
+
+bool PostStore::append(const PostInfo& post) {
+  if (_fs == NULL || needs_repair) return false;
+
+  uint8_t rec[POST_RECORD_MAX_SIZE];
+  int text_len = strlen(post.text);
+  if (text_len > MAX_POST_TEXT_LEN) text_len = MAX_POST_TEXT_LEN;
+
+  memcpy(rec, &post.post_timestamp, 4);
+  memcpy(&rec[4], post.author.pub_key, PUB_KEY_SIZE);
+  rec[POST_RECORD_HEADER_SIZE - 1] = text_len;
+  memcpy(&rec[POST_RECORD_HEADER_SIZE], post.text, text_len);
+  int len = POST_RECORD_HEADER_SIZE + text_len;
+
+  File f = openAppend(_fs, _filename);
+  if (!f) return false;
+  int n = f.write(rec, len);
+  f.close();
+
+  if (n != len) {
+    MESH_DEBUG_PRINTLN("PostStore: append failed");
+    if (n > 0) {   // partial record written, so file must be rewritten before next append
+      if (compact_state != COMPACT_IDLE) abortCompaction();   // its progress doesn't cover the partial record
+      needs_repair = true;
+      next_compact_check = millis();   // repair from next loop()
+    }
+    return false;
+  }
+
+  if (num_posts == 0) oldest_timestamp = post.post_timestamp;
+  addCheckpoint(post.post_timestamp, num_bytes);
+  num_posts++;
+  num_bytes += len;
+  return true;
+}
+
+bool PostStore::findNext(uint32_t since, uint32_t until, const mesh::Identity& exclude, PostInfo& dest) {
+  if (_fs == NULL || num_posts == 0) return false;
+
+  File f = openRead(_fs, _filename);
+  if (!f) return false;
+
+  bool found = false;
+  uint32_t pos = findStart(since);
+  if (f.seek(pos)) {
+    uint8_t rec[POST_RECORD_MAX_SIZE];
+    int len;
+    while (pos < num_bytes && (len = readRecord(f, rec)) > 0) {
+      pos += len;
+
+      uint32_t timestamp = recordTimestamp(rec);
+      if (timestamp <= since) continue;
+      if (timestamp > until) break;    // rest are all newer
+      if (memcmp(&rec[4], exclude.pub_key, PUB_KEY_SIZE) == 0) continue;
+
+      parseRecord(rec, dest);
+      found = true;
+      break;
+    }
+  }
+  f.close();
+  return found;
+}
+
+int PostStore::countSince(uint32_t since, const mesh::Identity& exclude, int max) {
+  if (_fs == NULL || num_posts == 0) return 0;
+
+  File f = openRead(_fs, _filename);
+  if (!f) return 0;
+
+  int count = 0, newer = 0;
+  uint32_t pos = findStart(since);
+  if (f.seek(pos)) {
+    uint8_t rec[POST_RECORD_MAX_SIZE];
+    int len;
+    while (newer < max && pos < num_bytes && (len = readRecord(f, rec)) > 0) {
+      pos += len;
+      if (recordTimestamp(rec) <= since) continue;
+      newer++;
+      if (memcmp(&rec[4], exclude.pub_key, PUB_KEY_SIZE) != 0) count++;
+    }
+  }
+  f.close();
+  return count;
+}
+
+bool PostStore::isOverLimits(uint32_t now) const {
+  if (num_posts > POST_STORE_MAX_POSTS || num_bytes > POST_STORE_MAX_BYTES) return true;
+#if POST_STORE_MAX_AGE_SECS > 0
+  if (num_posts > 0 && oldest_timestamp + POST_STORE_MAX_AGE_SECS < now) return true;
+#endif
+  return false;
+}
+
+void PostStore::startCompaction(uint32_t now) {
+  MESH_DEBUG_PRINTLN("PostStore: compacting, posts=%d, bytes=%d", num_posts, num_bytes);
+#if POST_STORE_MAX_AGE_SECS > 0
+  compact_min_timestamp = now > POST_STORE_MAX_AGE_SECS ? now - POST_STORE_MAX_AGE_SECS : 0;
+#else
+  compact_min_timestamp = 0;
+#endif
+  compact_pos = compact_cut = compact_dropped = 0;
+  compact_state = COMPACT_SKIP;
+}
+
+void PostStore::startCopy(uint32_t first_timestamp) {
+  File out = openWrite(_fs, _tmp_name);   // create empty temp file
+  if (!out) {
+    abortCompaction();
+    return;
+  }
+  out.close();
+
+  compact_cut = compact_pos;
+  compact_oldest = first_timestamp;
+  compact_state = COMPACT_COPY;
+}
+
+void PostStore::stepCompaction() {
+  File f = openRead(_fs, _filename);
+  if (!f) {
+    abortCompaction();
+    return;
+  }
+  File out;
+  if (compact_state == COMPACT_COPY) {
+    out = openAppend(_fs, _tmp_name);
+  }
+  bool ok = f.seek(compact_pos) && (compact_state != COMPACT_COPY || out);
+
+  uint8_t rec[POST_RECORD_MAX_SIZE];
+  for (int n = 0; ok && n < POST_STORE_COMPACT_BATCH && compact_pos < num_bytes; n++) {
+    int len = readRecord(f, rec);
+    if (len == 0) {
+      ok = false;
+    } else if (compact_state == COMPACT_SKIP) {
+      // drop oldest, until back under the limits (with some headroom, so compaction isn't repeated for every new post)
+      if (num_posts - compact_dropped > POST_STORE_MAX_POSTS*3/4 || num_bytes - compact_pos > POST_STORE_MAX_BYTES*3/4
+          || recordTimestamp(rec) < compact_min_timestamp) {
+        compact_dropped++;
+        compact_pos += len;
+      } else {
+        startCopy(recordTimestamp(rec));   // first record to keep, copy from next step
+        break;
+      }
+    } else if (out.write(rec, len) != len) {
+      ok = false;
+    } else {
+      compact_pos += len;
+    }
+  }
+  f.close();
+  if (out) out.close();
+
+  if (!ok) {
+    MESH_DEBUG_PRINTLN("PostStore: compaction failed");
+    abortCompaction();
+  } else if (compact_state != COMPACT_IDLE && compact_pos >= num_bytes) {
+    finishCompaction();
+  }
+}
+
+void PostStore::finishCompaction() {
+  // NOTE: temp file is complete at this point, so begin() recovers it if power is lost before the rename
+  _fs->remove(_filename);
+  if (compact_state == COMPACT_COPY) {
+    _fs->rename(_tmp_name, _filename);
+  } else {   // nothing kept
+    compact_cut = compact_pos;
+    compact_oldest = 0;
+  }
+
+  // drop checkpoints of removed records, and shift the rest
+  int j = 0;
+  for (int i = 0; i < num_index; i++) {
+    if (index[i].offset >= compact_cut) {
+      index[j].timestamp = index[i].timestamp;
+      index[j].offset = index[i].offset - compact_cut;
+      j++;
+    }
+  }
+  num_index = j;
+
+  num_posts -= compact_dropped;
+  num_bytes -= compact_cut;
+  oldest_timestamp = compact_oldest;
+  compact_state = COMPACT_IDLE;
+  needs_repair = false;   // (only whole records were copied)
+  MESH_DEBUG_PRINTLN("PostStore: compacted, posts=%d, bytes=%d", num_posts, num_bytes);
+}
+
+void PostStore::abortCompaction() {
+  _fs->remove(_tmp_name);
+  compact_state = COMPACT_IDLE;
+  next_compact_check = millis() + POST_STORE_RETRY_MILLIS;
+}
+
+void PostStore::loop(uint32_t now) {
+  if (_fs == NULL) return;
+
+  if (compact_state != COMPACT_IDLE) {
+    stepCompaction();
+  } else if ((long)(millis() - next_compact_check) >= 0) {
+    if (needs_repair) {
+      startRepair();
+    } else if (isOverLimits(now)) {
+      startCompaction(now);
+    }
+  }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <Arduino.h>   // needed for PlatformIO
+#include <Mesh.h>
+#include <helpers/IdentityStore.h>
+
+#define MAX_POST_TEXT_LEN    (160-9)
+
+struct PostInfo {
+  mesh::Identity author;
+  uint32_t post_timestamp;   // by OUR clock
+  char text[MAX_POST_TEXT_LEN+1];
+};
+
+// retention limits, compaction starts when any is exceeded
+#ifndef POST_STORE_MAX_POSTS
+  #define POST_STORE_MAX_POSTS      512
+#endif
+#ifndef POST_STORE_MAX_BYTES
+  #define POST_STORE_MAX_BYTES      (48*1024)
+#endif
+#ifndef POST_STORE_MAX_AGE_SECS
+  #define POST_STORE_MAX_AGE_SECS   (30*24*60*60)   // 0 = no age limit
+#endif
+
+#ifndef POST_STORE_INDEX_INTERVAL
+  #define POST_STORE_INDEX_INTERVAL    16    // posts between index checkpoints (doubles when index is full)
+#endif
+#ifndef POST_STORE_MAX_CHECKPOINTS
+  #define POST_STORE_MAX_CHECKPOINTS   64
+#endif
+
+#define POST_STORE_COMPACT_BATCH       8     // records processed per loop(), while compacting
+#define POST_STORE_RETRY_MILLIS    60000     // after a failed compaction
+
+#define POST_RECORD_HEADER_SIZE   (4 + PUB_KEY_SIZE + 1)   // timestamp, author, text_len
+#define POST_RECORD_MAX_SIZE      (POST_RECORD_HEADER_SIZE + MAX_POST_TEXT_LEN)
+
+/**
+ * \brief  Append-only log of room posts, with a RAM index of (timestamp -> file offset) checkpoints, so that
+ *         a client's sync cursor can be served from any point in the retained history, with sequential reads.
+ *         Old posts are dropped by compaction, done in small steps from loop() (copying kept records to a new file).
+ *         Record format: [4 post_timestamp][32 author pub_key][1 text_len][text]
+ */
+class PostStore {
+  struct Checkpoint {
+    uint32_t timestamp;
+    uint32_t offset;
+  };
+
+  FILESYSTEM* _fs;
+  const char* _filename;
+  char _tmp_name[32];
+  Checkpoint index[POST_STORE_MAX_CHECKPOINTS];
+  int num_index;
+  int index_interval, since_checkpoint;
+  uint32_t num_posts, num_bytes;   // (num_bytes is also offset of next append)
+  uint32_t oldest_timestamp;
+  unsigned long next_compact_check;
+  bool needs_repair;    // file has a partial record at end, appends are refused until rewritten
+
+  // compaction state
+  uint8_t compact_state;
+  uint32_t compact_pos, compact_cut, compact_dropped;
+  uint32_t compact_min_timestamp, compact_oldest;
+
+  void addCheckpoint(uint32_t timestamp, uint32_t offset);
+  uint32_t findStart(uint32_t since) const;
+  bool isOverLimits(uint32_t now) const;
+  void startCompaction(uint32_t now);
+  void startCopy(uint32_t first_timestamp);
+  void stepCompaction();
+  void finishCompaction();
+  void abortCompaction();
+  void startRepair();
+
+public:
+  PostStore(const char* filename);
+
+  /**
+   * \brief  scans the log to rebuild index, and loads the most recent posts into the 'recent' cyclic queue
+   * \returns  total number of posts loaded (recent[] is filled at (n % max_recent), oldest first)
+   */
+  int begin(FILESYSTEM* fs, PostInfo recent[], int max_recent);
+
+  /**
+   * \returns  false if post could not be written (also while the file is being repaired, after a failed write)
+   */
+  bool append(const PostInfo& post);
+
+  /**
+   * \brief  find the oldest post newer than 'since', and not newer than 'until', skipping those by 'exclude'
+   * \returns  false if none
+   */
+  bool findNext(uint32_t since, uint32_t until, const mesh::Identity& exclude, PostInfo& dest);
+
+  /**
+   * \returns  number of posts newer than 'since', not by 'exclude'. Reads at most 'max' posts newer than 'since',
+   *           so the result is capped at 'max', and is only a lower bound when it is near 'max'
+   */
+  int countSince(uint32_t since, const mesh::Identity& exclude, int max);
+
+  /**
+   * \brief  check retention limits, and do next step of any compaction or repair. (call from main loop)
+   * \param  now  current RTC time
+   */
+  void loop(uint32_t now);
+
+  uint32_t getNumPosts() const { return num_posts; }
+  uint32_t getNumBytes() const { return num_bytes; }
+  uint32_t getOldestTimestamp() const { return oldest_timestamp; }
+};
@@ -54,6 +54,14 @@
 #define REQ_TYPE_GET_TELEMETRY_DATA  0x03
 #define REQ_TYPE_GET_AVG_MIN_MAX     0x04
 #define REQ_TYPE_GET_ACCESS_LIST     0x05
+#define REQ_TYPE_GET_SERIES_LOG      0x06
+
+#define MAX_SERIES_LOG_REPLY         120   // leaves room for a long flood path, if sent in a path return
+#define SERIES_LOG_FLAG_BULK         0x01  // REQ_TYPE_GET_SERIES_LOG: requester can receive the whole log as a bulk transfer
+
+#define BULK_TIMEOUT_BASE_MILLIS          500
+#define BULK_PERHOP_FACTOR                6.0f
+#define BULK_PERHOP_EXTRA_MILLIS          250
 
 #define RESP_SERVER_LOGIN_OK      0   // response to ANON_REQ
 
@@ -220,6 +228,27 @@ uint8_t SensorMesh::handleRequest(uint8_t perms, uint32_t sender_timestamp, uint
     }
     return ofs;
   }
+  if (req_type == REQ_TYPE_GET_SERIES_LOG && (perms & PERM_ACL_ROLE_MASK) >= PERM_ACL_READ_ONLY) {
+    uint32_t since;
+    memcpy(&since, &payload[0], 4);
+    uint8_t series = payload[4];   // which of app's series
+    uint8_t res1 = payload[5];     // flags, otherwise reserved for future  (extra query params)
+
+    if (res1 == SERIES_LOG_FLAG_BULK && bulk_requester && !bulk.isSendActive(bulk_xfer_id)) {
+      // reply is the whole log as a bulk transfer: [tag][channel][lpp_type], then compressed blocks
+      memcpy(bulk_buf, &sender_timestamp, 4);
+      int len = querySeriesLog(series, since, &bulk_buf[4], sizeof(bulk_buf) - 4);
+      if (len > 0 && bulk.startSend(bulk_requester->id, bulk_requester->shared_secret, bulk_requester->out_path, bulk_requester->out_path_len,
+                                    bulk_buf, 4 + len, bulk_xfer_id)) {
+        bulk_reply_started = true;
+        return 0;
+      }
+    }
+    if (res1 == 0 || res1 == SERIES_LOG_FLAG_BULK) {   // otherwise, as much as fits in one response
+      // reply: [channel][lpp_type], then compressed blocks. Requester repeats with 'since' = last timestamp decoded, until empty
+      return 4 + querySeriesLog(series, since, &reply_data[4], MAX_SERIES_LOG_REPLY - 4);
+    }
+  }
   if (req_type == REQ_TYPE_GET_ACCESS_LIST && (perms & PERM_ACL_ROLE_MASK) == PERM_ACL_ADMIN) {
     uint8_t res1 = payload[0];   // reserved for future  (extra query params)
     uint8_t res2 = payload[1];
@@ -308,7 +337,8 @@ bool SensorMesh::allowPacketForward(const mesh::Packet* packet) {
 
 int SensorMesh::calcRxDelay(float score, uint32_t air_time) const {
   if (_prefs.rx_delay_base <= 0.0f) return 0;
-  return (int) ((pow(_prefs.rx_delay_base, 0.85f - score) - 1.0) * air_time);
+  rx_delay_curve.setBase(_prefs.rx_delay_base);   // (only recomputed if changed via CLI)
+  return rx_delay_curve.calc(score, air_time);
 }
 
 uint32_t SensorMesh::getRetransmitDelay(const mesh::Packet* packet) {
@@ -523,12 +553,17 @@ void SensorMesh::onPeerDataRecv(mesh::Packet* packet, uint8_t type, int sender_i
     memcpy(&timestamp, data, 4);
 
     if (timestamp > from->last_timestamp) {  // prevent replay attacks
+      bulk_requester = (packet->isRouteDirect() && from->out_path_len >= 0) ? from : NULL;   // bulk transfers are Direct only
+      bulk_reply_started = false;
       uint8_t reply_len = handleRequest(from->isAdmin() ? 0xFF : from->permissions, timestamp, data[4], &data[5], len - 5);
-      if (reply_len == 0) return;  // invalid command
+      bulk_requester = NULL;
+      if (reply_len == 0 && !bulk_reply_started) return;  // invalid command
 
       from->last_timestamp = timestamp;
       from->last_activity = getRTCClock()->getCurrentTime();
 
+      if (bulk_reply_started) return;   // reply is on its way, via 'bulk'
+
       if (packet->isRouteFlood()) {
         // let this sender know path TO here, so they can use sendDirect(), and ALSO encode the response
         mesh::Packet* path = createPathReturn(from->id, secret, packet->path, packet->path_len,
@@ -650,6 +685,23 @@ void SensorMesh::onControlDataRecv(mesh::Packet* packet) {
   }
 }
 
+void SensorMesh::onPeerMultipartRecv(mesh::Packet* packet, uint8_t type, int sender_idx, const uint8_t* secret, uint8_t* data, size_t len) {
+  int i = matching_peer_indexes[sender_idx];
+  if (i < 0 || i >= acl.getNumClients()) {
+    MESH_DEBUG_PRINTLN("onPeerMultipartRecv: Invalid sender idx: %d", i);
+    return;
+  }
+  ClientInfo* from = acl.getClientByIdx(i);
+  if (from->out_path_len >= 0) {
+    bulk.onMultipartRecv(type, from->id, secret, from->out_path, from->out_path_len, data, len);   // ACKs of our series log dumps
+  }
+}
+
+uint32_t SensorMesh::calcBulkTimeoutMillisFor(int pkt_len, int num_pkts, uint8_t path_len) {
+  uint32_t air_time = _radio->getEstAirtimeFor(pkt_len) * num_pkts;
+  return BULK_TIMEOUT_BASE_MILLIS + (air_time * BULK_PERHOP_FACTOR + BULK_PERHOP_EXTRA_MILLIS) * (path_len + 1);
+}
+
 bool SensorMesh::onPeerPathRecv(mesh::Packet* packet, int sender_idx, const uint8_t* secret, uint8_t* path, uint8_t path_len, uint8_t extra_type, uint8_t* extra, uint8_t extra_len) {
   int i = matching_peer_indexes[sender_idx];
   if (i < 0 || i >= acl.getNumClients()) {
@@ -691,13 +743,17 @@ void SensorMesh::onAckRecv(mesh::Packet* packet, uint32_t ack_crc) {
 
 SensorMesh::SensorMesh(mesh::MainBoard& board, mesh::Radio& radio, mesh::MillisecondClock& ms, mesh::RNG& rng, mesh::RTCClock& rtc, mesh::MeshTables& tables)
      : mesh::Mesh(radio, ms, rng, rtc, *new StaticPoolPacketManager(32), tables),
-      _cli(board, rtc, sensors, &_prefs, this), telemetry(MAX_PACKET_PAYLOAD - 4)
+      _cli(board, rtc, sensors, &_prefs, this), telemetry(MAX_PACKET_PAYLOAD - 4), rx_delay_curve(0.0f), bulk(*this, *this, NULL)
 {
   next_local_advert = next_flood_advert = 0;
   dirty_contacts_expiry = 0;
   last_read_time = 0;
+  last_sample_seq = 0;
   num_alert_tasks = 0;
   set_radio_at = revert_radio_at = 0;
+  bulk_xfer_id = 0;
+  bulk_requester = NULL;
+  bulk_reply_started = false;
 
   // defaults
   memset(&_prefs, 0, sizeof(_prefs));
@@ -856,6 +912,7 @@ bool  SensorMesh::getGPS(uint8_t channel, float& lat, float& lon, float& alt) {
 
 void SensorMesh::loop() {
   mesh::Mesh::loop();
+  bulk.loop();
 
   if (next_flood_advert && millisHasNowPassed(next_flood_advert)) {
     mesh::Packet* pkt = createSelfAdvert();
@@ -882,16 +939,20 @@ void SensorMesh::loop() {
     MESH_DEBUG_PRINTLN("Radio params restored");
   }
 
+  // only re-evaluate app's triggers when there are new readings: battery is due, or sensors have sampled (on their own schedule)
   uint32_t curr = getRTCClock()->getCurrentTime();
-  if (curr >= last_read_time + SENSOR_READ_INTERVAL_SECS) {
+  uint32_t sample_seq = sensors.getSampleSeq();
+  bool batt_due = curr >= last_read_time + SENSOR_READ_INTERVAL_SECS;
+  if (batt_due || sample_seq != last_sample_seq) {
     telemetry.reset();
     telemetry.addVoltage(TELEM_CHANNEL_SELF, (float)board.getBattMilliVolts() / 1000.0f);
-    // query other sensors -- target specific
+    // query other sensors -- target specific (from their cached readings)
     sensors.querySensors(0xFF, telemetry);  // allow all telemetry permissions
 
     onSensorDataRead();
 
-    last_read_time = curr;
+    if (batt_due) last_read_time = curr;
+    last_sample_seq = sample_seq;
   }
 
   // check the alert send queue
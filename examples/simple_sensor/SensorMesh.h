@@ -22,6 +22,7 @@
 #include <helpers/CommonCLI.h>
 #include <helpers/StatsFormatHelper.h>
 #include <helpers/ClientACL.h>
+#include <helpers/BulkTransfer.h>
 #include <RTClib.h>
 #include <target.h>
 
@@ -45,7 +46,7 @@
 #define MAX_SEARCH_RESULTS      8
 #define MAX_CONCURRENT_ALERTS   4
 
-class SensorMesh : public mesh::Mesh, public CommonCLICallbacks {
+class SensorMesh : public mesh::Mesh, public CommonCLICallbacks, public BulkTransferHost {
 public:
   SensorMesh(mesh::MainBoard& board, mesh::Radio& radio, mesh::MillisecondClock& ms, mesh::RNG& rng, mesh::RTCClock& rtc, mesh::MeshTables& tables);
   void begin(FILESYSTEM* fs);
@@ -80,6 +81,10 @@ public:
 
   float getTelemValue(uint8_t channel, uint8_t type);
 
+  // BulkTransferHost
+  uint32_t calcBulkTimeoutMillisFor(int pkt_len, int num_pkts, uint8_t path_len) override;
+  void onBulkRecvComplete(const mesh::Identity& sender, uint16_t xfer_id, const uint8_t* data, size_t len) override { }  // send-only
+
 protected:
   // current telemetry data queries
   float getVoltage(uint8_t channel) { return getTelemValue(channel, LPP_VOLTAGE); }
@@ -110,6 +115,7 @@ protected:
 
   virtual void onSensorDataRead() = 0;   // for app to implement
   virtual int querySeriesData(uint32_t start_secs_ago, uint32_t end_secs_ago, MinMaxAvg dest[], int max_num) = 0;  // for app to implement
+  virtual int querySeriesLog(uint8_t series, uint32_t since, uint8_t dest[], int max_len) { return 0; }  // [channel][lpp_type][SeriesLog::query()]
   virtual bool handleCustomCommand(uint32_t sender_timestamp, char* command, char* reply) { return false; }
 
   // Mesh overrides
@@ -124,6 +130,7 @@ protected:
   int searchPeersByHash(const uint8_t* hash) override;
   void getPeerSharedSecret(uint8_t* dest_secret, int peer_idx) override;
   void onPeerDataRecv(mesh::Packet* packet, uint8_t type, int sender_idx, const uint8_t* secret, uint8_t* data, size_t len) override;
+  void onPeerMultipartRecv(mesh::Packet* packet, uint8_t type, int sender_idx, const uint8_t* secret, uint8_t* data, size_t len) override;
   bool onPeerPathRecv(mesh::Packet* packet, int sender_idx, const uint8_t* secret, uint8_t* path, uint8_t path_len, uint8_t extra_type, uint8_t* extra, uint8_t extra_len) override;
   void onControlDataRecv(mesh::Packet* packet) override;
   void onAckRecv(mesh::Packet* packet, uint32_t ack_crc) override;
@@ -138,7 +145,9 @@ private:
   ClientACL  acl;
   unsigned long dirty_contacts_expiry;
   CayenneLPP telemetry;
+  mutable mesh::RxDelayCurve rx_delay_curve;
   uint32_t last_read_time;
+  uint32_t last_sample_seq;
   int matching_peer_indexes[MAX_SEARCH_RESULTS];
   int num_alert_tasks;
   Trigger* alert_tasks[MAX_CONCURRENT_ALERTS];
@@ -147,6 +156,11 @@ private:
   float pending_bw;
   uint8_t pending_sf;
   uint8_t pending_cr;
+  BulkTransferManager bulk;
+  uint8_t bulk_buf[BULK_MAX_TRANSFER_SIZE];   // series log dump, being sent
+  uint16_t bulk_xfer_id;
+  ClientInfo* bulk_requester;   // set while handling a Direct request, if requester can be sent a bulk reply
+  bool bulk_reply_started;
 
   uint8_t handleLoginReq(const mesh::Identity& sender, const uint8_t* secret, uint32_t sender_timestamp, const uint8_t* data);
   uint8_t handleRequest(uint8_t perms, uint32_t sender_timestamp, uint8_t req_type, uint8_t* payload, size_t payload_len);
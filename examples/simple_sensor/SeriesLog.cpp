@@ -0,0 +1,219 @@
+#include "SeriesLog.h"
+
+static File openRead(FILESYSTEM* _fs, const char* filename) {
+#if defined(RP2040_PLATFORM)
+  return _fs->open(filename, "r");
+#else
+  return _fs->open(filename);
+#endif
+}
+
+static File openAppend(FILESYSTEM* _fs, const char* filename) {
+#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+  return _fs->open(filename, FILE_O_WRITE);
+#elif defined(RP2040_PLATFORM)
+  return _fs->open(filename, "a");
+#else
+  return _fs->open(filename, "a", true);
+#endif
+}
+
+static uint32_t zigzag(int32_t n) {
+  return ((uint32_t)n << 1) ^ (uint32_t)(n >> 31);
+}
+
+static int timestampBits(uint32_t zz) {
+  if (zz == 0) return 1;
+  if (zz < (1 << 7)) return 2 + 7;
+  if (zz < (1 << 9)) return 3 + 9;
+  if (zz < (1 << 12)) return 4 + 12;
+  return 4 + 32;
+}
+
+static int valueBits(uint32_t zz) {
+  if (zz == 0) return 1;
+  if (zz < (1 << 6)) return 2 + 6;
+  if (zz < (1 << 12)) return 3 + 12;
+  return 3 + 32;
+}
+
+SeriesLog::SeriesLog(const char* base_name, uint32_t multiplier) : _fs(NULL), _base_name(base_name), _multiplier(multiplier) {
+  bit_pos = 0;
+  block[SERIES_BLOCK_HEADER_SIZE - 1] = 0;   // no open block
+  curr_seg = blocks_in_seg = 0;
+}
+
+void SeriesLog::segmentName(char* dest, int seg) const {
+  sprintf(dest, "%s%d", _base_name, seg);
+}
+
+void SeriesLog::begin(FILESYSTEM* fs) {
+  _fs = fs;
+
+  // current segment is the one with most recent block
+  uint32_t newest = 0;
+  curr_seg = blocks_in_seg = 0;
+  for (int seg = 0; seg < SERIES_LOG_NUM_SEGMENTS; seg++) {
+    char name[32];
+    segmentName(name, seg);
+    if (!_fs->exists(name)) continue;
+
+    File f = openRead(_fs, name);
+    if (!f) continue;
+    int n = 0;
+    uint32_t last = 0;
+    uint8_t len;
+    uint8_t hdr[SERIES_BLOCK_HEADER_SIZE];
+    while (f.read(&len, 1) == 1 && len >= SERIES_BLOCK_HEADER_SIZE && f.read(hdr, SERIES_BLOCK_HEADER_SIZE) == SERIES_BLOCK_HEADER_SIZE) {
+      memcpy(&last, &hdr[8], 4);
+      n++;
+      if (!f.seek(f.position() + len - SERIES_BLOCK_HEADER_SIZE)) break;
+    }
+    f.close();
+
+    if (n > 0 && last >= newest) {
+      newest = last;
+      curr_seg = seg;
+      blocks_in_seg = n;
+    }
+  }
+}
+
+void SeriesLog::writeBits(uint32_t bits, int n) {
+  while (n > 0) {
+    n--;
+    int byte_idx = bit_pos >> 3;
+    if (bits & (1UL << n)) {
+      block[byte_idx] |= (0x80 >> (bit_pos & 7));
+    } else {
+      block[byte_idx] &= ~(0x80 >> (bit_pos & 7));
+    }
+    bit_pos++;
+  }
+}
+
+void SeriesLog::startBlock(uint32_t timestamp, int32_t value) {
+  memcpy(&block[0], &timestamp, 4);
+  memcpy(&block[4], &value, 4);
+  memcpy(&block[8], &timestamp, 4);
+  block[SERIES_BLOCK_HEADER_SIZE - 1] = 1;
+  bit_pos = SERIES_BLOCK_HEADER_SIZE * 8;
+
+  prev_timestamp = timestamp;
+  prev_delta = 0;
+  prev_value = value;
+}
+
+void SeriesLog::sealBlock() {
+  if (blockCount() == 0) return;
+
+  if (_fs) {
+    if (blocks_in_seg >= SERIES_LOG_BLOCKS_PER_SEGMENT) {   // move to next segment, replacing oldest
+      curr_seg = (curr_seg + 1) % SERIES_LOG_NUM_SEGMENTS;
+      blocks_in_seg = 0;
+      char name[32];
+      segmentName(name, curr_seg);
+      _fs->remove(name);
+    }
+
+    char name[32];
+    segmentName(name, curr_seg);
+    File f = openAppend(_fs, name);
+    if (f) {
+      uint8_t len = (bit_pos + 7) >> 3;
+      f.write(&len, 1);
+      f.write(block, len);
+      f.close();
+      blocks_in_seg++;
+    }
+  }
+  block[SERIES_BLOCK_HEADER_SIZE - 1] = 0;
+}
+
+void SeriesLog::append(uint32_t timestamp, float value) {
+  int32_t v = (int32_t) lroundf(value * _multiplier);
+
+  if (blockCount() == 0) {
+    startBlock(timestamp, v);
+    return;
+  }
+  if (timestamp < prev_timestamp) {   // clock went backwards, start afresh
+    sealBlock();
+    startBlock(timestamp, v);
+    return;
+  }
+
+  int32_t delta = timestamp - prev_timestamp;
+  uint32_t ts_zz = zigzag(delta - prev_delta);
+  uint32_t val_zz = zigzag(v - prev_value);
+  if (bit_pos + timestampBits(ts_zz) + valueBits(val_zz) > SERIES_BLOCK_SIZE * 8 || blockCount() == 0xFF) {
+    sealBlock();   // block is full
+    startBlock(timestamp, v);
+    return;
+  }
+
+  if (ts_zz == 0) {
+    writeBits(0, 1);
+  } else if (ts_zz < (1 << 7)) {
+    writeBits(0b10, 2); writeBits(ts_zz, 7);
+  } else if (ts_zz < (1 << 9)) {
+    writeBits(0b110, 3); writeBits(ts_zz, 9);
+  } else if (ts_zz < (1 << 12)) {
+    writeBits(0b1110, 4); writeBits(ts_zz, 12);
+  } else {
+    writeBits(0b1111, 4); writeBits(ts_zz, 32);
+  }
+
+  if (val_zz == 0) {
+    writeBits(0, 1);
+  } else if (val_zz < (1 << 6)) {
+    writeBits(0b10, 2); writeBits(val_zz, 6);
+  } else if (val_zz < (1 << 12)) {
+    writeBits(0b110, 3); writeBits(val_zz, 12);
+  } else {
+    writeBits(0b111, 3); writeBits(val_zz, 32);
+  }
+
+  memcpy(&block[8], &timestamp, 4);   // last_timestamp
+  block[SERIES_BLOCK_HEADER_SIZE - 1]++;
+  prev_delta = delta;
+  prev_timestamp = timestamp;
+  prev_value = v;
+}
+
+int SeriesLog::query(uint32_t since, uint8_t* dest, int max_len) {
+  int ofs = 0;
+  bool full = false;
+
+  // segments, oldest first
+  for (int k = 1; _fs && k <= SERIES_LOG_NUM_SEGMENTS && !full; k++) {
+    char name[32];
+    segmentName(name, (curr_seg + k) % SERIES_LOG_NUM_SEGMENTS);
+    if (!_fs->exists(name)) continue;
+
+    File f = openRead(_fs, name);
+    if (!f) continue;
+    uint8_t len;
+    uint8_t buf[SERIES_BLOCK_SIZE];
+    while (f.read(&len, 1) == 1 && len >= SERIES_BLOCK_HEADER_SIZE && len <= SERIES_BLOCK_SIZE && f.read(buf, len) == len) {
+      uint32_t last;
+      memcpy(&last, &buf[8], 4);
+      if (last <= since) continue;   // all samples already seen
+
+      if (ofs + 1 + len > max_len) { full = true; break; }
+      dest[ofs++] = len;
+      memcpy(&dest[ofs], buf, len); ofs += len;
+    }
+    f.close();
+  }
+
+  // then the open block
+  uint32_t last;
+  memcpy(&last, &block[8], 4);
+  uint8_t len = (bit_pos + 7) >> 3;
+  if (!full && blockCount() > 0 && last > since && ofs + 1 + len <= max_len) {
+    dest[ofs++] = len;
+    memcpy(&dest[ofs], block, len); ofs += len;
+  }
+  return ofs;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Mesh.h>
+#include <helpers/IdentityStore.h>
+
+#ifndef SERIES_BLOCK_SIZE
+  #define SERIES_BLOCK_SIZE           96    // max bytes per compressed block (must fit in one response packet)
+#endif
+#ifndef SERIES_LOG_NUM_SEGMENTS
+  #define SERIES_LOG_NUM_SEGMENTS      4
+#endif
+#ifndef SERIES_LOG_BLOCKS_PER_SEGMENT
+  #define SERIES_LOG_BLOCKS_PER_SEGMENT  32
+#endif
+
+#define SERIES_BLOCK_HEADER_SIZE      13    // [4 first_timestamp][4 first_value][4 last_timestamp][1 count]
+
+/**
+ * \brief  Compressed log of (timestamp, value) samples, kept in flash as a ring of segment files.
+ *         Samples are packed into self-contained blocks (Gorilla style): values as fixed-point integers
+ *         (value * multiplier), then each subsequent sample as a delta-of-delta timestamp, and a value delta,
+ *         both as variable length bit codes. Whole blocks are sent to requesters as is.
+ *
+ *   timestamp delta-of-delta (zigzag):  '0' = same interval, '10'+7 bits, '110'+9 bits, '1110'+12 bits, '1111'+32 bits
+ *   value delta (zigzag):               '0' = same value,    '10'+6 bits, '110'+12 bits, '111'+32 bits
+ */
+class SeriesLog {
+  FILESYSTEM* _fs;
+  const char* _base_name;
+  uint32_t _multiplier;
+
+  // the open block
+  uint8_t block[SERIES_BLOCK_SIZE];
+  int bit_pos;
+  uint32_t prev_timestamp;
+  int32_t prev_delta, prev_value;
+
+  int curr_seg, blocks_in_seg;
+
+  void segmentName(char* dest, int seg) const;
+  void writeBits(uint32_t bits, int n);
+  void startBlock(uint32_t timestamp, int32_t value);
+  void sealBlock();
+  uint8_t blockCount() const { return block[SERIES_BLOCK_HEADER_SIZE - 1]; }
+
+public:
+  SeriesLog(const char* base_name, uint32_t multiplier);
+
+  void begin(FILESYSTEM* fs);
+  void append(uint32_t timestamp, float value);
+
+  /**
+   * \brief  write the open block to flash now (if any samples), so they survive a reboot. Next sample starts a new block.
+   */
+  void flush() { sealBlock(); }
+
+  /**
+   * \brief  copy blocks with any samples after 'since', as [1 len][block]..., oldest first, including the open block.
+   * \returns  number of bytes put in dest
+   */
+  int query(uint32_t since, uint8_t* dest, int max_len);
+};
@@ -1,45 +1,167 @@
 #include "TimeSeriesData.h"
 
+#define SERIES_FILE_VERSION   1
+
+static File openRead(FILESYSTEM* _fs, const char* filename) {
+#if defined(RP2040_PLATFORM)
+  return _fs->open(filename, "r");
+#else
+  return _fs->open(filename);
+#endif
+}
+
+static File openWrite(FILESYSTEM* _fs, const char* filename) {
+#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+  _fs->remove(filename);
+  return _fs->open(filename, FILE_O_WRITE);
+#elif defined(RP2040_PLATFORM)
+  return _fs->open(filename, "w");
+#else
+  return _fs->open(filename, "w", true);
+#endif
+}
+
+bool TimeSeriesData::addTier(int num, uint32_t secs) {
+  if (num_tiers >= MAX_SERIES_TIERS) return false;
+
+  auto t = &tiers[num_tiers++];
+  t->buckets = new SeriesBucket[num];
+  memset(t->buckets, 0, sizeof(SeriesBucket)*num);
+  t->num_buckets = num;
+  t->head = 0;
+  t->interval_secs = secs;
+  t->head_start = 0;
+  return true;
+}
+
+void TimeSeriesData::advanceTier(SeriesTier& t, uint32_t now) {
+  uint32_t start = now - (now % t.interval_secs);
+  if (start <= t.head_start) return;   // still in head bucket  (or clock went backwards)
+
+  // empty the buckets for any intervals skipped, and the new head
+  uint32_t steps = (start - t.head_start) / t.interval_secs;
+  if (steps > t.num_buckets) steps = t.num_buckets;
+  while (steps > 0) {
+    t.head = (t.head + 1) % t.num_buckets;
+    t.buckets[t.head]._count = 0;
+    steps--;
+  }
+  t.head_start = start;
+}
+
 void TimeSeriesData::recordData(mesh::RTCClock* clock, float value) {
   uint32_t now = clock->getCurrentTime();
-  if (now >= last_timestamp + interval_secs) {
-    last_timestamp = now;
+  for (int k = 0; k < num_tiers; k++) {
+    advanceTier(tiers[k], now);
 
-    data[next] = value;   // append to cycle table
-    next = (next + 1) % num_slots;
+    auto b = &tiers[k].buckets[tiers[k].head];
+    if (b->_count == 0) {
+      b->_min = b->_max = b->_sum = value;
+    } else {
+      if (value < b->_min) b->_min = value;
+      if (value > b->_max) b->_max = value;
+      b->_sum += value;
+    }
+    b->_count++;
   }
+  if (_log) _log->append(now, value);
 }
 
 void TimeSeriesData::calcMinMaxAvg(mesh::RTCClock* clock, uint32_t start_secs_ago, uint32_t end_secs_ago, MinMaxAvg* dest, uint8_t channel, uint8_t lpp_type) const {
-  int i = next, n = num_slots;
-  uint32_t ago = clock->getCurrentTime() - last_timestamp;
-  int num_values = 0;
+  uint32_t count = 0;
   float total = 0.0f;
 
   dest->_channel = channel;
   dest->_lpp_type = lpp_type;
 
-  // start at most recet recording, back-track through to oldest
-  while (n > 0) {
-    n--;
-    i = (i + num_slots - 1) % num_slots;  // go back by one
-    if (ago >= end_secs_ago && ago < start_secs_ago) {   // filter by the desired time range
-      float v = data[i];
-      num_values++;
-      total += v;
-      if (num_values == 1) {
-        dest->_max = dest->_min = v;
-      } else {
-        if (v < dest->_min) dest->_min = v;
-        if (v > dest->_max) dest->_max = v;
+  if (num_tiers > 0) {
+    // finest tier that reaches back far enough
+    int k = 0;
+    while (k < num_tiers - 1 && tiers[k].num_buckets * tiers[k].interval_secs < start_secs_ago) k++;
+    const SeriesTier& t = tiers[k];
+
+    uint32_t now = clock->getCurrentTime();
+    uint32_t ago = now > t.head_start ? now - t.head_start : 0;
+
+    // start at most recent bucket, back-track until before the desired time range
+    int i = t.head;
+    for (int n = 0; n < t.num_buckets && ago < start_secs_ago; n++) {
+      auto b = &t.buckets[i];
+      if (ago >= end_secs_ago && b->_count > 0) {
+        if (count == 0) {
+          dest->_min = b->_min;
+          dest->_max = b->_max;
+        } else {
+          if (b->_min < dest->_min) dest->_min = b->_min;
+          if (b->_max > dest->_max) dest->_max = b->_max;
+        }
+        total += b->_sum;
+        count += b->_count;
       }
+      i = (i + t.num_buckets - 1) % t.num_buckets;  // go back by one
+      ago += t.interval_secs;
     }
-    ago += interval_secs;
   }
   // calc average
-  if (num_values > 0) {
-    dest->_avg = total / num_values;
+  if (count > 0) {
+    dest->_avg = total / count;
   } else {
     dest->_max = dest->_min = dest->_avg = NAN;
   }
 }
+
+bool TimeSeriesData::save(FILESYSTEM* fs, const char* filename) const {
+  File file = openWrite(fs, filename);
+  if (!file) return false;
+
+  uint8_t hdr[2] = { SERIES_FILE_VERSION, (uint8_t) num_tiers };
+  bool success = file.write(hdr, 2) == 2;
+  for (int k = 0; success && k < num_tiers; k++) {
+    auto t = &tiers[k];
+    success = success && (file.write((const uint8_t *) &t->interval_secs, 4) == 4);
+    success = success && (file.write((const uint8_t *) &t->num_buckets, 4) == 4);
+    success = success && (file.write((const uint8_t *) &t->head, 4) == 4);
+    success = success && (file.write((const uint8_t *) &t->head_start, 4) == 4);
+    size_t sz = sizeof(SeriesBucket) * t->num_buckets;
+    success = success && (file.write((const uint8_t *) t->buckets, sz) == sz);
+  }
+  file.close();
+  return success;
+}
+
+bool TimeSeriesData::load(FILESYSTEM* fs, const char* filename) {
+  if (!fs->exists(filename)) return false;
+  File file = openRead(fs, filename);
+  if (!file) return false;
+
+  uint8_t hdr[2];
+  bool success = file.read(hdr, 2) == 2 && hdr[0] == SERIES_FILE_VERSION && hdr[1] == num_tiers;
+  for (int k = 0; success && k < num_tiers; k++) {
+    auto t = &tiers[k];
+    uint32_t interval_secs;
+    int num_buckets, head;
+    uint32_t head_start;
+    success = success && (file.read((uint8_t *) &interval_secs, 4) == 4);
+    success = success && (file.read((uint8_t *) &num_buckets, 4) == 4);
+    success = success && (file.read((uint8_t *) &head, 4) == 4);
+    success = success && (file.read((uint8_t *) &head_start, 4) == 4);
+    success = success && interval_secs == t->interval_secs && num_buckets == t->num_buckets && head >= 0 && head < num_buckets;
+
+    size_t sz = sizeof(SeriesBucket) * t->num_buckets;
+    success = success && (file.read((uint8_t *) t->buckets, sz) == sz);
+    if (success) {
+      t->head = head;
+      t->head_start = head_start;
+    }
+  }
+  file.close();
+
+  if (!success) {   // start afresh
+    for (int k = 0; k < num_tiers; k++) {
+      memset(tiers[k].buckets, 0, sizeof(SeriesBucket)*tiers[k].num_buckets);
+      tiers[k].head = 0;
+      tiers[k].head_start = 0;
+    }
+  }
+  return success;
+}
@@ -2,28 +2,60 @@
 
 #include <Arduino.h>
 #include <Mesh.h>
+#include <helpers/IdentityStore.h>
+#include "SeriesLog.h"
+
+#ifndef MAX_SERIES_TIERS
+  #define MAX_SERIES_TIERS   4
+#endif
 
 struct MinMaxAvg {
   float _min, _max, _avg;
   uint8_t _lpp_type, _channel;
 };
 
-class TimeSeriesData {
-  float* data;
-  int num_slots, next;
-  uint32_t last_timestamp;
+struct SeriesBucket {
+  float _min, _max, _sum;
+  uint32_t _count;     // zero if no values recorded in this interval
+};
+
+struct SeriesTier {
+  SeriesBucket* buckets;
+  int num_buckets, head;     // head is most recent bucket
   uint32_t interval_secs;
+  uint32_t head_start;       // start time of head bucket (multiple of interval_secs)
+};
+
+/**
+ * \brief  RRD style time series. Each tier is a ring of fixed interval buckets, holding min/max/sum/count of
+ *         all values recorded in the interval. Tiers are added finest first, eg. 5-min for 1 day, then 1-hour for 7 days.
+ */
+class TimeSeriesData {
+  SeriesTier tiers[MAX_SERIES_TIERS];
+  int num_tiers;
+  SeriesLog* _log;
+
+  void advanceTier(SeriesTier& t, uint32_t now);
 
 public:
-  TimeSeriesData(float* array, int num, uint32_t secs) : num_slots(num), data(array), last_timestamp(0), next(0), interval_secs(secs) { 
-    memset(data, 0, sizeof(float)*num);
-  }
-  TimeSeriesData(int num, uint32_t secs) : num_slots(num), last_timestamp(0), next(0), interval_secs(secs) {
-    data = new float[num];
-    memset(data, 0, sizeof(float)*num);
-  }
+  TimeSeriesData() : num_tiers(0), _log(NULL) { }
+  TimeSeriesData(int num, uint32_t secs) : num_tiers(0), _log(NULL) { addTier(num, secs); }
+
+  void setLog(SeriesLog* log) { _log = log; }   // also keep all raw samples, compressed in flash
+
+  /**
+   * \brief  add next coarser tier, of 'num' buckets, each of 'secs' interval
+   */
+  bool addTier(int num, uint32_t secs);
 
   void recordData(mesh::RTCClock* clock, float value);
+
+  /**
+   * \brief  aggregate values between the given times, from finest tier which holds the whole range
+   *         (or the coarsest, if none do)
+   */
   void calcMinMaxAvg(mesh::RTCClock* clock, uint32_t start_secs_ago, uint32_t end_secs_ago, MinMaxAvg* dest, uint8_t channel, uint8_t lpp_type) const;
-};
 
+  bool save(FILESYSTEM* fs, const char* filename) const;
+  bool load(FILESYSTEM* fs, const char* filename);   // (ignored if tiers have since been re-configured)
+};
@@ -5,23 +5,70 @@
   static UITask ui_task(display);
 #endif
 
+#ifndef BATT_RECORD_INTERVAL_SECS
+  #define BATT_RECORD_INTERVAL_SECS   60
+#endif
+#ifndef SERIES_SAVE_INTERVAL_SECS
+  #define SERIES_SAVE_INTERVAL_SECS   (60*60)    // 0 = don't persist series data
+#endif
+#ifndef BATT_LOG_FLUSH_INTERVAL_SECS
+  #define BATT_LOG_FLUSH_INTERVAL_SECS   (60*60)   // bounds battery log readings lost on power loss (independent of series saving)
+#endif
+
 class MyMesh : public SensorMesh {
 public:
   MyMesh(mesh::MainBoard& board, mesh::Radio& radio, mesh::MillisecondClock& ms, mesh::RNG& rng, mesh::RTCClock& rtc, mesh::MeshTables& tables)
-     : SensorMesh(board, radio, ms, rng, rtc, tables), 
-       battery_data(12*24, 5*60)    // 24 hours worth of battery data, every 5 minutes
+     : SensorMesh(board, radio, ms, rng, rtc, tables), battery_log("/batt_log", 100)   // (LPP_VOLTAGE is 0.01V)
   {
+    battery_data.addTier(12*24, 5*60);      // 5-minute intervals, for 24 hours
+    battery_data.addTier(24*7, 60*60);      // hourly, for 7 days
+    battery_data.addTier(90, 24*60*60);     // daily, for 90 days
+    battery_data.setLog(&battery_log);
+    _fs = NULL;
+    next_series_save = 0;
+    next_batt_record = 0;
+    next_log_flush = 0;
+  }
+
+  void begin(FILESYSTEM* fs) {
+    SensorMesh::begin(fs);
+    _fs = fs;
+    battery_log.begin(_fs);
+  #if SERIES_SAVE_INTERVAL_SECS > 0
+    battery_data.load(_fs, "/batt_series");
+  #endif
   }
 
 protected:
   /* ========================== custom logic here ========================== */
   Trigger low_batt, critical_batt;
   TimeSeriesData  battery_data;
+  SeriesLog  battery_log;
+  FILESYSTEM* _fs;
+  uint32_t next_series_save;
+  uint32_t next_batt_record;
+  uint32_t next_log_flush;
 
   void onSensorDataRead() override {
     float batt_voltage = getVoltage(TELEM_CHANNEL_SELF);
 
-    battery_data.recordData(getRTCClock(), batt_voltage);   // record battery
+    uint32_t now = getRTCClock()->getCurrentTime();
+    if (now >= next_batt_record) {   // (also called whenever other sensors have new readings)
+      battery_data.recordData(getRTCClock(), batt_voltage);   // record battery
+      next_batt_record = now + BATT_RECORD_INTERVAL_SECS;
+    }
+  #if SERIES_SAVE_INTERVAL_SECS > 0
+    if (now >= next_series_save) {
+      if (next_series_save) {   // (not right after boot)
+        battery_data.save(_fs, "/batt_series");
+      }
+      next_series_save = now + SERIES_SAVE_INTERVAL_SECS;
+    }
+  #endif
+    if (now >= next_log_flush) {
+      if (next_log_flush) battery_log.flush();    // open block is only in RAM until sealed
+      next_log_flush = now + BATT_LOG_FLUSH_INTERVAL_SECS;
+    }
     alertIf(batt_voltage < 3.4f, critical_batt, HIGH_PRI_ALERT, "Battery is critical!");
     alertIf(batt_voltage < 3.6f, low_batt, LOW_PRI_ALERT, "Battery is low");
   }
@@ -31,6 +78,13 @@ protected:
     return 1;
   }
 
+  int querySeriesLog(uint8_t series, uint32_t since, uint8_t dest[], int max_len) override {
+    if (series != 0) return 0;
+    dest[0] = TELEM_CHANNEL_SELF;
+    dest[1] = LPP_VOLTAGE;
+    return 2 + battery_log.query(since, &dest[2], max_len - 2);
+  }
+
   bool handleCustomCommand(uint32_t sender_timestamp, char* command, char* reply) override {
     if (strcmp(command, "magic") == 0) {    // example 'custom' command handling
       strcpy(reply, "**Magic now done**");
@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""
+Host-side tools for the compressed series log (see SeriesLog.h)
+
+  series_decode.py reply <hex> [--multiplier N]       decode a REQ_TYPE_GET_SERIES_LOG reply (after the 4 byte tag)
+                                                      (or the reassembled chunks of a bulk reply, SERIES_LOG_FLAG_BULK)
+  series_decode.py segment <file> [--multiplier N]    decode a segment file, copied from the node's flash (eg. /batt_log0)
+  series_decode.py bench <csv> [--multiplier N]       compress a 'timestamp,value' trace, and compare with 4 byte floats
+
+Decoded samples are written to stdout as CSV: timestamp,value
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+BLOCK_SIZE = 96
+HEADER_SIZE = 13
+
+
+class BitReader:
+    def __init__(self, data, pos):
+        self.data = data
+        self.pos = pos * 8
+
+    def read(self, n):
+        v = 0
+        for _ in range(n):
+            byte = self.data[self.pos >> 3]
+            v = (v << 1) | ((byte >> (7 - (self.pos & 7))) & 1)
+            self.pos += 1
+        return v
+
+    def prefix(self, max_ones):
+        n = 0
+        while n < max_ones and self.read(1) == 1:
+            n += 1
+        return n
+
+
+class BitWriter:
+    def __init__(self):
+        self.bits = []
+
+    def write(self, v, n):
+        for i in range(n - 1, -1, -1):
+            self.bits.append((v >> i) & 1)
+
+    def num_bits(self):
+        return len(self.bits)
+
+    def to_bytes(self):
+        out = bytearray((len(self.bits) + 7) // 8)
+        for i, b in enumerate(self.bits):
+            if b:
+                out[i >> 3] |= 0x80 >> (i & 7)
+        return bytes(out)
+
+
+def zigzag(n):
+    return ((n << 1) ^ (n >> 31)) & 0xFFFFFFFF
+
+
+def unzigzag(z):
+    return (z >> 1) ^ -(z & 1)
+
+
+def to_int32(v):
+    v &= 0xFFFFFFFF
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+TS_PAYLOAD_BITS = [0, 7, 9, 12, 32]   # by number of leading '1's in prefix
+VAL_PAYLOAD_BITS = [0, 6, 12, 32]
+
+
+def ts_bits(zz):
+    if zz == 0: return 1
+    if zz < (1 << 7): return 2 + 7
+    if zz < (1 << 9): return 3 + 9
+    if zz < (1 << 12): return 4 + 12
+    return 4 + 32
+
+
+def val_bits(zz):
+    if zz == 0: return 1
+    if zz < (1 << 6): return 2 + 6
+    if zz < (1 << 12): return 3 + 12
+    return 3 + 32
+
+
+def write_ts(w, zz):
+    if zz == 0: w.write(0, 1)
+    elif zz < (1 << 7): w.write(0b10, 2); w.write(zz, 7)
+    elif zz < (1 << 9): w.write(0b110, 3); w.write(zz, 9)
+    elif zz < (1 << 12): w.write(0b1110, 4); w.write(zz, 12)
+    else: w.write(0b1111, 4); w.write(zz, 32)
+
+
+def write_val(w, zz):
+    if zz == 0: w.write(0, 1)
+    elif zz < (1 << 6): w.write(0b10, 2); w.write(zz, 6)
+    elif zz < (1 << 12): w.write(0b110, 3); w.write(zz, 12)
+    else: w.write(0b111, 3); w.write(zz, 32)
+
+
+def decode_block(block, multiplier):
+    first_ts, first_val, _last_ts, count = struct.unpack_from("<IiIB", block, 0)
+    samples = [(first_ts, first_val / multiplier)]
+    r = BitReader(block, HEADER_SIZE)
+    ts, delta, val = first_ts, 0, first_val
+    for _ in range(count - 1):
+        ones = r.prefix(4)
+        if ones > 0:
+            delta += unzigzag(r.read(TS_PAYLOAD_BITS[ones]))
+        ones = r.prefix(3)
+        if ones > 0:
+            val = to_int32(val + unzigzag(r.read(VAL_PAYLOAD_BITS[ones])))
+        ts = (ts + delta) & 0xFFFFFFFF
+        samples.append((ts, val / multiplier))
+    return samples
+
+
+def decode_blocks(data, ofs, multiplier):
+    """ decodes consecutive [1 len][block] entries """
+    samples = []
+    while ofs < len(data):
+        n = data[ofs]
+        if n < HEADER_SIZE or ofs + 1 + n > len(data):
+            print("truncated block at offset %d" % ofs, file=sys.stderr)
+            break
+        samples += decode_block(data[ofs + 1:ofs + 1 + n], multiplier)
+        ofs += 1 + n
+    return samples
+
+
+def encode(trace, multiplier):
+    """ mirrors SeriesLog::append(), returns list of sealed blocks """
+    blocks = []
+    w = None
+    count = 0
+    for ts, value in trace:
+        v = int(round(value * multiplier))
+        if w is not None:
+            delta = ts - prev_ts
+            ts_zz, val_zz = zigzag(delta - prev_delta), zigzag(v - prev_val)
+            if ts < prev_ts or count == 0xFF or \
+                    HEADER_SIZE * 8 + w.num_bits() + ts_bits(ts_zz) + val_bits(val_zz) > BLOCK_SIZE * 8:
+                blocks.append(struct.pack("<IiIB", first_ts, first_val, prev_ts, count) + w.to_bytes())
+                w = None
+        if w is None:
+            w = BitWriter()
+            first_ts, first_val, count = ts, v, 1
+            prev_ts, prev_delta, prev_val = ts, 0, v
+            continue
+
+        write_ts(w, ts_zz)
+        write_val(w, val_zz)
+        count += 1
+        prev_delta, prev_ts, prev_val = delta, ts, v
+
+    if w is not None:
+        blocks.append(struct.pack("<IiIB", first_ts, first_val, prev_ts, count) + w.to_bytes())
+    return blocks
+
+
+def write_csv(samples):
+    out = csv.writer(sys.stdout)
+    out.writerow(["timestamp", "value"])
+    for ts, value in samples:
+        out.writerow([ts, value])
+
+
+def bench(filename, multiplier):
+    trace = []
+    with open(filename, newline="") as f:
+        for row in csv.reader(f):
+            try:
+                trace.append((int(row[0]), float(row[1])))
+            except (ValueError, IndexError):
+                continue   # header, or blank line
+
+    blocks = encode(trace, multiplier)
+    compressed = sum(1 + len(b) for b in blocks)
+    raw = len(trace) * 4        # float values (timestamps implied by interval)
+    raw_ts = len(trace) * 8     # float values + timestamps
+
+    # check round trip
+    decoded = decode_blocks(b"".join(bytes([len(b)]) + b for b in blocks), 0, multiplier)
+    ok = len(decoded) == len(trace) and all(
+        d[0] == t[0] and abs(d[1] - t[1]) <= 0.5 / multiplier + 1e-9 for d, t in zip(decoded, trace))
+
+    print("samples:       %d" % len(trace))
+    print("blocks:        %d" % len(blocks))
+    print("compressed:    %d bytes (%.2f bits/sample)" % (compressed, compressed * 8.0 / max(1, len(trace))))
+    print("raw floats:    %d bytes (%.1fx)" % (raw, raw / max(1, compressed)))
+    print("raw + ts:      %d bytes (%.1fx)" % (raw_ts, raw_ts / max(1, compressed)))
+    print("round trip:    %s" % ("OK" if ok else "MISMATCH"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode/benchmark compressed sensor series")
+    parser.add_argument("mode", choices=["reply", "segment", "bench"])
+    parser.add_argument("input", help="hex string (reply), or file name")
+    parser.add_argument("--multiplier", type=float, default=100, help="fixed-point multiplier of the series (default 100)")
+    args = parser.parse_args()
+
+    if args.mode == "reply":
+        data = bytes.fromhex(args.input)
+        if len(data) < 2:
+            sys.exit("reply too short")
+        print("# channel=%d, lpp_type=%d" % (data[0], data[1]), file=sys.stderr)
+        write_csv(decode_blocks(data, 2, args.multiplier))
+    elif args.mode == "segment":
+        with open(args.input, "rb") as f:
+            write_csv(decode_blocks(f.read(), 0, args.multiplier))
+    else:
+        bench(args.input, args.multiplier)
+
+
+if __name__ == "__main__":
+    main()
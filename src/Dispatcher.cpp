@@ -14,22 +14,61 @@ namespace mesh {
   #define NOISE_FLOOR_CALIB_INTERVAL   2000     // 2 seconds
 #endif
 
+void Dispatcher::initRadioSlot(RadioSlot& slot, Radio* radio, uint8_t policy) {
+  memset(&slot, 0, sizeof(slot));
+  slot.radio = radio;
+  slot.policy = policy;
+  slot.prev_isrecv_mode = true;
+}
+
+int Dispatcher::addRadio(Radio& radio, uint8_t policy) {
+  if (num_radios >= MAX_DISPATCH_RADIOS) return -1;
+
+  initRadioSlot(radios[num_radios], &radio, policy);
+  return num_radios++;
+}
+
 void Dispatcher::begin() {
   n_sent_flood = n_sent_direct = 0;
   n_recv_flood = n_recv_direct = 0;
   _err_flags = 0;
-  radio_nonrx_start = _ms->getMillis();
 
-  _radio->begin();
-  prev_isrecv_mode = _radio->isInRecvMode();
+  for (int i = 0; i < num_radios; i++) {
+    RadioSlot& slot = radios[i];
+    slot.radio_nonrx_start = _ms->getMillis();
+    slot.radio->begin();
+    slot.prev_isrecv_mode = slot.radio->isInRecvMode();
+  }
 }
 
 float Dispatcher::getAirtimeBudgetFactor() const {
   return 2.0;   // default, 33.3%  (1/3rd)
 }
 
+void RxDelayCurve::setBase(float base) {
+  if (base == _base) return;
+
+  _base = base;
+  for (int i = 0; i <= RX_DELAY_CURVE_STEPS; i++) {
+    _factor[i] = base > 0.0f ? pow(base, 0.85f - (float)i / RX_DELAY_CURVE_STEPS) - 1.0f : 0.0f;
+  }
+}
+
+int RxDelayCurve::calc(float score, uint32_t air_time) const {
+  if (score < 0.0f) score = 0.0f;
+  if (score > 1.0f) score = 1.0f;
+
+  // linear interpolation between the two nearest steps
+  float pos = score * RX_DELAY_CURVE_STEPS;
+  int i = (int) pos;
+  if (i >= RX_DELAY_CURVE_STEPS) return (int) (_factor[RX_DELAY_CURVE_STEPS] * air_time);
+  float f = _factor[i] + (_factor[i + 1] - _factor[i]) * (pos - i);
+  return (int) (f * air_time);
+}
+
 int Dispatcher::calcRxDelay(float score, uint32_t air_time) const {
-  return (int) ((pow(10, 0.85f - score) - 1.0) * air_time);
+  static RxDelayCurve curve(10.0f);
+  return curve.calc(score, air_time);
 }
 
 uint32_t Dispatcher::getCADFailRetryDelay() const {
@@ -40,34 +79,63 @@ uint32_t Dispatcher::getCADFailMaxDuration() const {
 }
 
 void Dispatcher::loop() {
-  if (millisHasNowPassed(next_floor_calib_time)) {
-    _radio->triggerNoiseFloorCalibrate(getInterferenceThreshold());
-    next_floor_calib_time = futureMillis(NOISE_FLOOR_CALIB_INTERVAL);
+  bool any_idle = false;
+  for (int i = 0; i < num_radios; i++) {
+    if (checkRadio(radios[i])) any_idle = true;
+  }
+  if (!any_idle) return;   // can't do any more radio activity until a send is complete or timed out
+
+  // check inbound (delayed) queue
+  {
+    Packet* pkt = _mgr->getNextInbound(_ms->getMillis());
+    if (pkt) {
+    #if MESH_STATS
+      _stats.rx_delay_wait.add(_ms->getMillis() - pkt->_queued_at);
+    #endif
+      processRecvPacket(pkt);
+    }
+  }
+  for (int i = 0; i < num_radios; i++) {
+    if (radios[i].outbound == NULL) checkRecv(radios[i], i);
   }
-  _radio->loop();
+  for (int i = 0; i < num_radios; i++) {
+    if (radios[i].outbound == NULL) checkSend(radios[i], i);
+  }
+}
+
+// returns false if radio is still busy sending
+bool Dispatcher::checkRadio(RadioSlot& slot) {
+  Radio* radio = slot.radio;
+  if (millisHasNowPassed(slot.next_floor_calib_time)) {
+    radio->triggerNoiseFloorCalibrate(getInterferenceThreshold());
+    slot.next_floor_calib_time = futureMillis(NOISE_FLOOR_CALIB_INTERVAL);
+  }
+  radio->loop();
 
   // check for radio 'stuck' in mode other than Rx
-  bool is_recv = _radio->isInRecvMode();
-  if (is_recv != prev_isrecv_mode) {
-    prev_isrecv_mode = is_recv;
+  bool is_recv = radio->isInRecvMode();
+  if (is_recv != slot.prev_isrecv_mode) {
+    slot.prev_isrecv_mode = is_recv;
     if (!is_recv) {
-      radio_nonrx_start = _ms->getMillis();
+      slot.radio_nonrx_start = _ms->getMillis();
     }
   }
-  if (!is_recv && _ms->getMillis() - radio_nonrx_start > 8000) {   // radio has not been in Rx mode for 8 seconds!
+  if (!is_recv && _ms->getMillis() - slot.radio_nonrx_start > 8000) {   // radio has not been in Rx mode for 8 seconds!
     _err_flags |= ERR_EVENT_STARTRX_TIMEOUT;
   }
 
+  Packet* outbound = slot.outbound;
   if (outbound) {  // waiting for outbound send to be completed
-    if (_radio->isSendComplete()) {
-      long t = _ms->getMillis() - outbound_start;
+    if (radio->isSendComplete()) {
+      long t = _ms->getMillis() - slot.outbound_start;
+      slot.total_air_time += t;
       total_air_time += t;  // keep track of how much air time we are using
       //Serial.print("  airtime="); Serial.println(t);
 
       // will need radio silence up to next_tx_time
-      next_tx_time = futureMillis(t * getAirtimeBudgetFactor());
+      slot.next_tx_time = futureMillis(t * getAirtimeBudgetFactor());
 
-      _radio->onSendFinished();
+      radio->onSendFinished();
       logTx(outbound, 2 + outbound->path_len + outbound->payload_len);
       if (outbound->isRouteFlood()) {
         n_sent_flood++;
@@ -75,52 +143,53 @@ void Dispatcher::loop() {
         n_sent_direct++;
       }
       releasePacket(outbound);  // return to pool
-      outbound = NULL;
-    } else if (millisHasNowPassed(outbound_expiry)) {
+      slot.outbound = NULL;
+    } else if (millisHasNowPassed(slot.outbound_expiry)) {
       MESH_DEBUG_PRINTLN("%s Dispatcher::loop(): WARNING: outbound packed send timed out!", getLogDateTime());
 
-      _radio->onSendFinished();
+      radio->onSendFinished();
       logTxFail(outbound, 2 + outbound->path_len + outbound->payload_len);
+    #if MESH_STATS
+      _stats.drops[STATS_DROP_TX_TIMEOUT]++;
+    #endif
 
       releasePacket(outbound);  // return to pool
-      outbound = NULL;
+      slot.outbound = NULL;
     } else {
-      return;  // can't do any more radio activity until send is complete or timed out
+      return false;
     }
 
     // going back into receive mode now...
-    next_agc_reset_time = futureMillis(getAGCResetInterval());
+    slot.next_agc_reset_time = futureMillis(getAGCResetInterval());
   }
 
-  if (getAGCResetInterval() > 0 && millisHasNowPassed(next_agc_reset_time)) {
-    _radio->resetAGC();
-    next_agc_reset_time = futureMillis(getAGCResetInterval());
+  if (getAGCResetInterval() > 0 && millisHasNowPassed(slot.next_agc_reset_time)) {
+    radio->resetAGC();
+    slot.next_agc_reset_time = futureMillis(getAGCResetInterval());
   }
-
-  // check inbound (delayed) queue
-  {
-    Packet* pkt = _mgr->getNextInbound(_ms->getMillis());
-    if (pkt) {
-      processRecvPacket(pkt);
-    }
-  }
-  checkRecv();
-  checkSend();
+  return true;
 }
 
-void Dispatcher::checkRecv() {
+void Dispatcher::checkRecv(RadioSlot& slot, uint8_t idx) {
+  Radio* radio = slot.radio;
   Packet* pkt;
   float score;
   uint32_t air_time;
   {
     uint8_t raw[MAX_TRANS_UNIT+1];
-    int len = _radio->recvRaw(raw, MAX_TRANS_UNIT);
+    int len = radio->recvRaw(raw, MAX_TRANS_UNIT);
+    if (len > 0 && (slot.policy & RADIO_POLICY_RX) == 0) {
+      len = 0;   // this radio is send-only, discard
+    }
     if (len > 0) {
-      logRxRaw(_radio->getLastSNR(), _radio->getLastRSSI(), raw, len);
+      logRxRaw(radio->getLastSNR(), radio->getLastRSSI(), raw, len);
 
       pkt = _mgr->allocNew();
       if (pkt == NULL) {
         MESH_DEBUG_PRINTLN("%s Dispatcher::checkRecv(): WARNING: received data, no unused packets available!", getLogDateTime());
+      #if MESH_STATS
+        _stats.drops[STATS_DROP_RX_POOL_EMPTY]++;
+      #endif
       } else {
         int i = 0;
 #ifdef NODE_ID
@@ -143,6 +212,9 @@ void Dispatcher::checkRecv() {
 
         if (pkt->path_len > MAX_PATH_SIZE || i + pkt->path_len > len) {
           MESH_DEBUG_PRINTLN("%s Dispatcher::checkRecv(): partial or corrupt packet received, len=%d", getLogDateTime(), len);
+        #if MESH_STATS
+          _stats.drops[STATS_DROP_RX_CORRUPT]++;
+        #endif
           _mgr->free(pkt);  // put back into pool
           pkt = NULL;
         } else {
@@ -151,14 +223,20 @@ void Dispatcher::checkRecv() {
           pkt->payload_len = len - i;  // payload is remainder
           if (pkt->payload_len > sizeof(pkt->payload)) {
             MESH_DEBUG_PRINTLN("%s Dispatcher::checkRecv(): packet payload too big, payload_len=%d", getLogDateTime(), (uint32_t)pkt->payload_len);
+          #if MESH_STATS
+            _stats.drops[STATS_DROP_RX_TOO_BIG]++;
+          #endif
             _mgr->free(pkt);  // put back into pool
             pkt = NULL;  
           } else {
             memcpy(pkt->payload, &raw[i], pkt->payload_len);
 
-            pkt->_snr = _radio->getLastSNR() * 4.0f;
-            score = _radio->packetScore(_radio->getLastSNR(), len);
-            air_time = _radio->getEstAirtimeFor(len);
+            pkt->_snr = radio->getLastSNR() * 4.0f;
+            pkt->_rssi = radio->getLastRSSI();   // (radio's 'last' values will be of a later packet, by the time this is processed)
+            pkt->_radio_idx = idx;
+            score = radio->packetScore(radio->getLastSNR(), len);
+            air_time = radio->getEstAirtimeFor(len);
+            slot.rx_air_time += air_time;
             rx_air_time += air_time;
           }
         }
@@ -172,7 +250,7 @@ void Dispatcher::checkRecv() {
     Serial.print(getLogDateTime());
     Serial.printf(": RX, len=%d (type=%d, route=%s, payload_len=%d) SNR=%d RSSI=%d score=%d time=%d", 
             pkt->getRawLength(), pkt->getPayloadType(), pkt->isRouteDirect() ? "D" : "F", pkt->payload_len,
-            (int)pkt->getSNR(), (int)_radio->getLastRSSI(), (int)(score*1000), air_time);
+            (int)pkt->getSNR(), (int)pkt->getRSSI(), (int)(score*1000), air_time);
 
     static uint8_t packet_hash[MAX_HASH_SIZE];
     pkt->calculatePacketHash(packet_hash);
@@ -200,6 +278,9 @@ void Dispatcher::checkRecv() {
         if (_delay > MAX_RX_DELAY_MILLIS) {
           _delay = MAX_RX_DELAY_MILLIS;
         }
+      #if MESH_STATS
+        pkt->_queued_at = _ms->getMillis();
+      #endif
         _mgr->queueInbound(pkt, futureMillis(_delay)); // add to delayed inbound queue
       }
     } else {
@@ -210,7 +291,17 @@ void Dispatcher::checkRecv() {
 }
 
 void Dispatcher::processRecvPacket(Packet* pkt) {
+#if MESH_STATS
+  uint8_t type = pkt->getPayloadType();
+  uint32_t t0 = MESH_STATS_MICROS();
+#endif
   DispatcherAction action = onRecvPacket(pkt);
+#if MESH_STATS
+  uint32_t t = MESH_STATS_MICROS() - t0;
+  _stats.recv_by_type[type]++;
+  _stats.process_micros_by_type[type] += t;
+  if (t > _stats.process_max_micros_by_type[type]) _stats.process_max_micros_by_type[type] = t;
+#endif
   if (action == ACTION_RELEASE) {
     _mgr->free(pkt);
   } else if (action == ACTION_MANUAL_HOLD) {
@@ -219,33 +310,80 @@ void Dispatcher::processRecvPacket(Packet* pkt) {
     uint8_t priority = (action >> 24) - 1;
     uint32_t _delay = action & 0xFFFFFF;
 
-    _mgr->queueOutbound(pkt, priority, futureMillis(_delay));
+    queueOutbound(pkt, priority, _delay);
+  }
+}
+
+uint8_t Dispatcher::getTxRadiosFor(const Packet* packet) const {
+  uint8_t need = packet->isRouteFlood() ? RADIO_POLICY_TX_FLOOD : RADIO_POLICY_TX_DIRECT;
+  uint8_t mask = 0;
+  for (int i = 0; i < num_radios; i++) {
+    if (radios[i].policy & need) mask |= (1 << i);
   }
+  return mask;
 }
 
-void Dispatcher::checkSend() {
-  if (_mgr->getOutboundCount(_ms->getMillis()) == 0) return;  // nothing waiting to send
-  if (!millisHasNowPassed(next_tx_time)) return;   // still in 'radio silence' phase (from airtime budget setting)
-  if (_radio->isReceiving()) {   // LBT - check if radio is currently mid-receive, or if channel activity
-    if (cad_busy_start == 0) {
-      cad_busy_start = _ms->getMillis();   // record when CAD busy state started
+void Dispatcher::queueOutbound(Packet* packet, uint8_t priority, uint32_t delay_millis) {
+  uint8_t mask = getTxRadiosFor(packet);
+  if (mask == 0) {
+    MESH_DEBUG_PRINTLN("%s Dispatcher::queueOutbound(): no radio to send on", getLogDateTime());
+    _mgr->free(packet);
+    return;
+  }
+
+  for (int i = 0; i < num_radios && mask; i++) {
+    uint8_t bit = 1 << i;
+    if ((mask & bit) == 0) continue;
+    mask &= ~bit;
+
+    Packet* pkt = packet;
+    if (mask) {   // more radios to send on after this, so queue a copy for this one
+      pkt = _mgr->allocNew();
+      if (pkt == NULL) {
+        _err_flags |= ERR_EVENT_FULL;
+        continue;
+      }
+      *pkt = *packet;
+    }
+    pkt->_radio_idx = i;
+  #if MESH_STATS
+    pkt->_queued_at = futureMillis(delay_millis);
+    pkt->_queued_pri = priority;
+  #endif
+    _mgr->queueOutbound(pkt, priority, futureMillis(delay_millis));
+  }
+}
+
+void Dispatcher::checkSend(RadioSlot& slot, uint8_t idx) {
+  Radio* radio = slot.radio;
+  if (_mgr->getOutboundCountFor(idx, _ms->getMillis()) == 0) return;  // nothing waiting to send
+  if (!millisHasNowPassed(slot.next_tx_time)) return;   // still in 'radio silence' phase (from airtime budget setting)
+  if (radio->isReceiving()) {   // LBT - check if radio is currently mid-receive, or if channel activity
+    if (slot.cad_busy_start == 0) {
+      slot.cad_busy_start = _ms->getMillis();   // record when CAD busy state started
     }
 
-    if (_ms->getMillis() - cad_busy_start > getCADFailMaxDuration()) {
+    if (_ms->getMillis() - slot.cad_busy_start > getCADFailMaxDuration()) {
       _err_flags |= ERR_EVENT_CAD_TIMEOUT;
 
       MESH_DEBUG_PRINTLN("%s Dispatcher::checkSend(): CAD busy max duration reached!", getLogDateTime());
       // channel activity has gone on too long... (Radio might be in a bad state)
       // force the pending transmit below...
     } else {
-      next_tx_time = futureMillis(getCADFailRetryDelay());
+      slot.next_tx_time = futureMillis(getCADFailRetryDelay());
       return;
     }
   }
-  cad_busy_start = 0;  // reset busy state
+#if MESH_STATS
+  if (slot.cad_busy_start) _stats.cad_busy.add(_ms->getMillis() - slot.cad_busy_start);
+#endif
+  slot.cad_busy_start = 0;  // reset busy state
 
-  outbound = _mgr->getNextOutbound(_ms->getMillis());
+  Packet* outbound = slot.outbound = _mgr->getNextOutboundFor(idx, _ms->getMillis());
   if (outbound) {
+  #if MESH_STATS
+    _stats.tx_queue_wait[MeshStats::getPriorityClass(outbound->_queued_pri)].add(_ms->getMillis() - outbound->_queued_at);
+  #endif
     int len = 0;
     uint8_t raw[MAX_TRANS_UNIT];
 
@@ -262,24 +400,30 @@ void Dispatcher::checkSend() {
 
     if (len + outbound->payload_len > MAX_TRANS_UNIT) {
       MESH_DEBUG_PRINTLN("%s Dispatcher::checkSend(): FATAL: Invalid packet queued... too long, len=%d", getLogDateTime(), len + outbound->payload_len);
+    #if MESH_STATS
+      _stats.drops[STATS_DROP_TX_INVALID]++;
+    #endif
       _mgr->free(outbound);
-      outbound = NULL;
+      slot.outbound = NULL;
     } else {
       memcpy(&raw[len], outbound->payload, outbound->payload_len); len += outbound->payload_len;
 
-      uint32_t max_airtime = _radio->getEstAirtimeFor(len)*3/2;
-      outbound_start = _ms->getMillis();
-      bool success = _radio->startSendRaw(raw, len);
+      uint32_t max_airtime = radio->getEstAirtimeFor(len)*3/2;
+      slot.outbound_start = _ms->getMillis();
+      bool success = radio->startSendRaw(raw, len);
       if (!success) {
         MESH_DEBUG_PRINTLN("%s Dispatcher::loop(): ERROR: send start failed!", getLogDateTime());
 
         logTxFail(outbound, outbound->getRawLength());
+      #if MESH_STATS
+        _stats.drops[STATS_DROP_TX_START_FAIL]++;
+      #endif
   
         releasePacket(outbound);  // return to pool
-        outbound = NULL;
+        slot.outbound = NULL;
         return;
       }
-      outbound_expiry = futureMillis(max_airtime);
+      slot.outbound_expiry = futureMillis(max_airtime);
 
     #if MESH_PACKET_LOGGING
       Serial.print(getLogDateTime());
@@ -303,6 +447,8 @@ Packet* Dispatcher::obtainNewPacket() {
   } else {
     pkt->payload_len = pkt->path_len = 0;
     pkt->_snr = 0;
+    pkt->_rssi = 0;
+    pkt->_radio_idx = 0;
   }
   return pkt;
 }
@@ -316,7 +462,7 @@ void Dispatcher::sendPacket(Packet* packet, uint8_t priority, uint32_t delay_mil
     MESH_DEBUG_PRINTLN("%s Dispatcher::sendPacket(): ERROR: invalid packet... path_len=%d, payload_len=%d", getLogDateTime(), (uint32_t) packet->path_len, (uint32_t) packet->payload_len);
     _mgr->free(packet);
   } else {
-    _mgr->queueOutbound(packet, priority, futureMillis(delay_millis));
+    queueOutbound(packet, priority, delay_millis);
   }
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <MeshCore.h>
+#include <MeshStats.h>
 #include <Identity.h>
 #include <Packet.h>
 #include <Utils.h>
@@ -16,6 +17,27 @@ public:
   virtual unsigned long getMillis() = 0;
 };
 
+#define RX_DELAY_CURVE_STEPS   64
+
+/**
+ * \brief  Precomputed flood RX delay curve: (base^(0.85 - score) - 1), sampled at score = 0..1 in RX_DELAY_CURVE_STEPS steps,
+ *         so per-packet delay is just a lookup, linear interpolation, and multiply by air time.
+*/
+class RxDelayCurve {
+  float _base;
+  float _factor[RX_DELAY_CURVE_STEPS + 1];
+
+public:
+  RxDelayCurve(float base) { _base = -1; setBase(base); }
+
+  void setBase(float base);   // (only recomputes if changed)
+
+  /**
+   * \returns  RX delay in millis, or zero if base <= 0 (disabled)
+  */
+  int calc(float score, uint32_t air_time) const;
+};
+
 /**
  * \brief  Abstraction of this device's packet radio.
 */
@@ -38,6 +60,11 @@ public:
 
   virtual float packetScore(float snr, int packet_len) = 0;
 
+  /**
+   * \returns  approx minimum SNR (dB) that can be demodulated, with the radio's current settings.
+  */
+  virtual float getSNRFloor() { return -15.0f; }   // (SF10)
+
   /**
    * \brief  starts the raw packet send. (no wait)
    * \param  bytes   the raw packet data
@@ -89,7 +116,9 @@ public:
 
   virtual void queueOutbound(Packet* packet, uint8_t priority, uint32_t scheduled_for) = 0;
   virtual Packet* getNextOutbound(uint32_t now) = 0;    // by priority
+  virtual Packet* getNextOutboundFor(uint8_t radio_idx, uint32_t now) = 0;   // by priority, only those with matching _radio_idx
   virtual int getOutboundCount(uint32_t now) const = 0;
+  virtual int getOutboundCountFor(uint8_t radio_idx, uint32_t now) const = 0;
   virtual int getFreeCount() const = 0;
   virtual Packet* getOutboundByIdx(int i) = 0;
   virtual Packet* removeOutboundByIdx(int i) = 0;
@@ -104,6 +133,15 @@ typedef uint32_t  DispatcherAction;
 #define ACTION_RETRANSMIT(pri)   (((uint32_t)1 + (pri))<<24)
 #define ACTION_RETRANSMIT_DELAYED(pri, _delay)  ((((uint32_t)1 + (pri))<<24) | (_delay))
 
+#ifndef MAX_DISPATCH_RADIOS
+  #define MAX_DISPATCH_RADIOS   2     // max 8
+#endif
+
+#define RADIO_POLICY_RX          0x01   // receive on this radio
+#define RADIO_POLICY_TX_FLOOD    0x02   // send flood packets on this radio
+#define RADIO_POLICY_TX_DIRECT   0x04   // send direct packets on this radio
+#define RADIO_POLICY_ALL         (RADIO_POLICY_RX | RADIO_POLICY_TX_FLOOD | RADIO_POLICY_TX_DIRECT)
+
 #define ERR_EVENT_FULL              (1 << 0)
 #define ERR_EVENT_CAD_TIMEOUT       (1 << 1)
 #define ERR_EVENT_STARTRX_TIMEOUT   (1 << 2)
@@ -111,37 +149,48 @@ typedef uint32_t  DispatcherAction;
 /**
  * \brief  The low-level task that manages detecting incoming Packets, and the queueing
  *      and scheduling of outbound Packets.
+ *      Can drive several radios (eg. dual-band, or LoRa + ESP-NOW), each with its own TX slot, airtime budget
+ *      and CAD state. The packet pool, outbound queue and MeshTables are shared.
 */
 class Dispatcher {
-  Packet* outbound;  // current outbound packet
-  unsigned long outbound_expiry, outbound_start, total_air_time, rx_air_time;
-  unsigned long next_tx_time;
-  unsigned long cad_busy_start;
-  unsigned long radio_nonrx_start;
-  unsigned long next_floor_calib_time, next_agc_reset_time;
-  bool  prev_isrecv_mode;
+  struct RadioSlot {
+    Radio* radio;
+    uint8_t policy;    // RADIO_POLICY_*
+    Packet* outbound;  // current outbound packet
+    unsigned long outbound_expiry, outbound_start, total_air_time, rx_air_time;
+    unsigned long next_tx_time;
+    unsigned long cad_busy_start;
+    unsigned long radio_nonrx_start;
+    unsigned long next_floor_calib_time, next_agc_reset_time;
+    bool  prev_isrecv_mode;
+  };
+
+  RadioSlot radios[MAX_DISPATCH_RADIOS];
+  int num_radios;
+  unsigned long total_air_time, rx_air_time;
   uint32_t n_sent_flood, n_sent_direct;
   uint32_t n_recv_flood, n_recv_direct;
 
+  void initRadioSlot(RadioSlot& slot, Radio* radio, uint8_t policy);
   void processRecvPacket(Packet* pkt);
+  void queueOutbound(Packet* packet, uint8_t priority, uint32_t delay_millis);
 
 protected:
   PacketManager* _mgr;
-  Radio* _radio;
+  Radio* _radio;     // the primary radio
   MillisecondClock* _ms;
   uint16_t _err_flags;
+#if MESH_STATS
+  MeshStats _stats;
+#endif
 
   Dispatcher(Radio& radio, MillisecondClock& ms, PacketManager& mgr)
     : _radio(&radio), _ms(&ms), _mgr(&mgr)
   {
-    outbound = NULL;
+    num_radios = 1;
+    initRadioSlot(radios[0], &radio, RADIO_POLICY_ALL);
     total_air_time = rx_air_time = 0;
-    next_tx_time = 0;
-    cad_busy_start = 0;
-    next_floor_calib_time = next_agc_reset_time = 0;
     _err_flags = 0;
-    radio_nonrx_start = 0;
-    prev_isrecv_mode = true;
   }
 
   virtual DispatcherAction onRecvPacket(Packet* pkt) = 0;
@@ -160,6 +209,12 @@ protected:
   virtual int getInterferenceThreshold() const { return 0; }    // disabled by default
   virtual int getAGCResetInterval() const { return 0; }    // disabled by default
 
+  /**
+   * \brief  which radios an outbound packet is to be sent on. (a copy is queued for each)
+   * \returns  bitmask of radio indexes. Default is all radios whose policy allows the packet's route type.
+   */
+  virtual uint8_t getTxRadiosFor(const Packet* packet) const;
+
 public:
   void begin();
   void loop();
@@ -168,6 +223,19 @@ public:
   void releasePacket(Packet* packet);
   void sendPacket(Packet* packet, uint8_t priority, uint32_t delay_millis=0);
 
+  /**
+   * \brief  add another radio. Must be called before begin().
+   * \param  policy  RADIO_POLICY_* flags
+   * \returns  index of the new radio, or -1 if already at MAX_DISPATCH_RADIOS
+   */
+  int addRadio(Radio& radio, uint8_t policy=RADIO_POLICY_ALL);
+  void setRadioPolicy(int idx, uint8_t policy) { radios[idx].policy = policy; }
+  uint8_t getRadioPolicy(int idx) const { return radios[idx].policy; }
+  int getNumRadios() const { return num_radios; }
+  Radio* getRadio(int idx) const { return radios[idx].radio; }
+  unsigned long getRadioAirTime(int idx) const { return radios[idx].total_air_time; }  // in milliseconds
+  bool isTxBudgetAvailable(int idx=0) const { return millisHasNowPassed(radios[idx].next_tx_time); }  // false during airtime budget 'silence'
+
   unsigned long getTotalAirTime() const { return total_air_time; }  // in milliseconds
   unsigned long getReceiveAirTime() const {return rx_air_time; }
   uint32_t getNumSentFlood() const { return n_sent_flood; }
@@ -177,15 +245,22 @@ public:
   void resetStats() {
     n_sent_flood = n_sent_direct = n_recv_flood = n_recv_direct = 0;
     _err_flags = 0;
+  #if MESH_STATS
+    _stats.reset();
+  #endif
   }
+#if MESH_STATS
+  const MeshStats& getDetailStats() const { return _stats; }
+#endif
 
   // helper methods
   bool millisHasNowPassed(unsigned long timestamp) const;
   unsigned long futureMillis(int millis_from_now) const;
 
 private:
-  void checkRecv();
-  void checkSend();
+  bool checkRadio(RadioSlot& slot);
+  void checkRecv(RadioSlot& slot, uint8_t idx);
+  void checkSend(RadioSlot& slot, uint8_t idx);
 };
 
 }
@@ -98,7 +98,12 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
     return ACTION_RELEASE;   // this node is NOT the next hop (OR this packet has already been forwarded), so discard.
   }
 
-  if (pkt->isRouteFlood() && filterRecvFloodPacket(pkt)) return ACTION_RELEASE;
+  if (pkt->isRouteFlood() && filterRecvFloodPacket(pkt)) {
+  #if MESH_STATS
+    _stats.drops[STATS_DROP_FLOOD_FILTERED]++;
+  #endif
+    return ACTION_RELEASE;
+  }
 
   DispatcherAction action = ACTION_RELEASE;
 
@@ -142,7 +147,7 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
 
             // decrypt, checking MAC is valid
             uint8_t data[MAX_PACKET_PAYLOAD];
-            int len = Utils::MACThenDecrypt(secret, data, macAndData, pkt->payload_len - i);
+            int len = macThenDecrypt(secret, data, macAndData, pkt->payload_len - i);
             if (len > 0) {  // success!
               if (pkt->getPayloadType() == PAYLOAD_TYPE_PATH) {
                 int k = 0;
@@ -192,7 +197,7 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
 
           // decrypt, checking MAC is valid
           uint8_t data[MAX_PACKET_PAYLOAD];
-          int len = Utils::MACThenDecrypt(secret, data, macAndData, pkt->payload_len - i);
+          int len = macThenDecrypt(secret, data, macAndData, pkt->payload_len - i);
           if (len > 0) {  // success!
             onAnonDataRecv(pkt, secret, sender, data, len);
             pkt->markDoNotRetransmit();
@@ -218,7 +223,7 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
         for (int j = 0; j < num; j++) {
           // decrypt, checking MAC is valid
           uint8_t data[MAX_PACKET_PAYLOAD];
-          int len = Utils::MACThenDecrypt(channels[j].secret, data, macAndData, pkt->payload_len - i);
+          int len = macThenDecrypt(channels[j].secret, data, macAndData, pkt->payload_len - i);
           if (len > 0) {  // success!
             onGroupDataRecv(pkt, pkt->getPayloadType(), channels[j], data, len);
             break;
@@ -294,6 +299,28 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
             onAckRecv(&tmp, ack_crc);
             //action = routeRecvPacket(&tmp);  // NOTE: currently not needed, as multipart ACKs not sent Flood
           }
+        } else if ((type == MULTIPART_TYPE_BULK_DATA || type == MULTIPART_TYPE_BULK_ACK) && pkt->isRouteDirect()) {
+          int i = 1;
+          uint8_t dest_hash = pkt->payload[i++];
+          uint8_t src_hash = pkt->payload[i++];
+
+          uint8_t* macAndData = &pkt->payload[i];   // MAC + encrypted data 
+          if (i + CIPHER_MAC_SIZE >= pkt->payload_len) {
+            MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): incomplete multipart packet", getLogDateTime());
+          } else if (self_id.isHashMatch(&dest_hash) && !_tables->hasSeen(pkt)) {
+            int num = searchPeersByHash(&src_hash);
+            for (int j = 0; j < num; j++) {
+              uint8_t secret[PUB_KEY_SIZE];
+              getPeerSharedSecret(secret, j);
+
+              uint8_t data[MAX_PACKET_PAYLOAD];
+              int len = macThenDecrypt(secret, data, macAndData, pkt->payload_len - i);
+              if (len > 0) {  // success!
+                onPeerMultipartRecv(pkt, type, j, secret, data, len);
+                break;
+              }
+            }
+          }
         } else {
           // FUTURE: other multipart types??
         }
@@ -322,6 +349,15 @@ void Mesh::removeSelfFromPath(Packet* pkt) {
 #endif
 }
 
+int Mesh::macThenDecrypt(const uint8_t* shared_secret, uint8_t* dest, const uint8_t* src, int src_len) {
+  int len = Utils::MACThenDecrypt(shared_secret, dest, src, src_len);
+#if MESH_STATS
+  _stats.decrypt_attempts++;
+  if (len <= 0) _stats.decrypt_failures++;
+#endif
+  return len;
+}
+
 DispatcherAction Mesh::routeRecvPacket(Packet* packet) {
   if (packet->isRouteFlood() && !packet->isMarkedDoNotRetransmit()
     && packet->path_len + PATH_HASH_SIZE <= MAX_PATH_SIZE && allowPacketForward(packet)) {
@@ -332,6 +368,9 @@ DispatcherAction Mesh::routeRecvPacket(Packet* packet) {
     // as this propagates outwards, give it lower and lower priority
     return ACTION_RETRANSMIT_DELAYED(packet->path_len, d);   // give priority to closer sources, than ones further away
   }
+#if MESH_STATS
+  if (packet->isRouteFlood() && !packet->isMarkedDoNotRetransmit()) _stats.drops[STATS_DROP_NOT_FORWARDED]++;
+#endif
   return ACTION_RELEASE;
 }
 
@@ -351,6 +390,13 @@ DispatcherAction Mesh::forwardMultipartDirect(Packet* pkt) {
       removeSelfFromPath(&tmp);
       routeDirectRecvAcks(&tmp, ((uint32_t)remaining + 1) * 300);  // expect multipart ACKs 300ms apart (x2)
     }
+  } else if (type == MULTIPART_TYPE_BULK_DATA || type == MULTIPART_TYPE_BULK_ACK) {
+    if (!_tables->hasSeen(pkt)) {
+      removeSelfFromPath(pkt);
+
+      uint32_t d = getDirectRetransmitDelay(pkt);
+      return ACTION_RETRANSMIT_DELAYED(0, d);  // same as other Routed traffic
+    }
   }
   return ACTION_RELEASE;
 }
@@ -565,6 +611,32 @@ Packet* Mesh::createMultiAck(uint32_t ack_crc, uint8_t remaining) {
   return packet;
 }
 
+Packet* Mesh::createMultipartDatagram(uint8_t type, const Identity& dest, const uint8_t* secret, const uint8_t* data, size_t data_len) {
+  if (type == MULTIPART_TYPE_BULK_DATA || type == MULTIPART_TYPE_BULK_ACK) {
+    int enc_len = ((data_len + CIPHER_BLOCK_SIZE-1) / CIPHER_BLOCK_SIZE) * CIPHER_BLOCK_SIZE;
+    if (1 + 2*PATH_HASH_SIZE + CIPHER_MAC_SIZE + enc_len > MAX_PACKET_PAYLOAD) return NULL;
+  } else {
+    return NULL;  // invalid type
+  }
+
+  Packet* packet = obtainNewPacket();
+  if (packet == NULL) {
+    MESH_DEBUG_PRINTLN("%s Mesh::createMultipartDatagram(): error, packet pool empty", getLogDateTime());
+    return NULL;
+  }
+  packet->header = (PAYLOAD_TYPE_MULTIPART << PH_TYPE_SHIFT);  // ROUTE_TYPE_* set later
+
+  int len = 0;
+  packet->payload[len++] = type;   // NOTE: 'remaining' (upper 4 bits) not used for these types
+  len += dest.copyHashTo(&packet->payload[len]);  // dest hash
+  len += self_id.copyHashTo(&packet->payload[len]);  // src hash
+  len += Utils::encryptThenMAC(secret, &packet->payload[len], data, data_len);
+
+  packet->payload_len = len;
+
+  return packet;
+}
+
 Packet* Mesh::createRawData(const uint8_t* data, size_t len) {
   if (len > sizeof(Packet::payload)) return NULL;  // invalid arg
 
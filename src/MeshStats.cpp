@@ -0,0 +1,108 @@
+#include "MeshStats.h"
+
+#if MESH_STATS
+
+#include <string.h>
+
+namespace mesh {
+
+static const uint32_t hist_bounds[STATS_HIST_BUCKETS - 1] = { 10, 50, 100, 500, 1000, 5000, 10000 };
+
+void StatsHistogram::add(uint32_t value) {
+  int i = 0;
+  while (i < STATS_HIST_BUCKETS - 1 && value >= hist_bounds[i]) i++;
+  buckets[i]++;
+  count++;
+  if (value > max) max = value;
+}
+
+uint32_t StatsHistogram::getBucketBound(int i) const {
+  return i < STATS_HIST_BUCKETS - 1 ? hist_bounds[i] : 0xFFFFFFFF;
+}
+
+void MeshStats::reset() {
+  memset(this, 0, sizeof(*this));
+}
+
+int MeshStats::getPriorityClass(uint8_t priority) {
+  if (priority == 0) return 0;
+  if (priority <= 2) return 1;
+  if (priority <= 5) return 2;
+  return 3;
+}
+
+static int putU16(uint8_t* dest, uint32_t value) {
+  uint16_t v = value > 0xFFFF ? 0xFFFF : value;   // saturate
+  memcpy(dest, &v, 2);
+  return 2;
+}
+
+static int putHistogram(uint8_t* dest, const StatsHistogram& h) {
+  int i = 0;
+  for (int b = 0; b < STATS_HIST_BUCKETS; b++) i += putU16(&dest[i], h.buckets[b]);
+  i += putU16(&dest[i], h.max);
+  return i;
+}
+
+int MeshStats::writeSection(uint8_t section, uint8_t* dest, int max_len) const {
+  int i = 0;
+  dest[i++] = section;
+  if (section == STATS_SECTION_QUEUES) {
+    if (max_len < 1 + (2 + STATS_NUM_PRI_CLASSES) * (STATS_HIST_BUCKETS + 1) * 2) return 0;
+    i += putHistogram(&dest[i], rx_delay_wait);
+    for (int c = 0; c < STATS_NUM_PRI_CLASSES; c++) i += putHistogram(&dest[i], tx_queue_wait[c]);
+    i += putHistogram(&dest[i], cad_busy);
+  } else if (section == STATS_SECTION_TYPES) {
+    if (max_len < 1 + STATS_NUM_PAYLOAD_TYPES * 6) return 0;
+    for (int t = 0; t < STATS_NUM_PAYLOAD_TYPES; t++) {
+      i += putU16(&dest[i], recv_by_type[t]);
+      i += putU16(&dest[i], recv_by_type[t] ? process_micros_by_type[t] / recv_by_type[t] : 0);   // avg
+      i += putU16(&dest[i], process_max_micros_by_type[t]);
+    }
+  } else if (section == STATS_SECTION_DROPS) {
+    if (max_len < 1 + STATS_NUM_DROP_REASONS * 2 + 8) return 0;
+    for (int r = 0; r < STATS_NUM_DROP_REASONS; r++) i += putU16(&dest[i], drops[r]);
+    memcpy(&dest[i], &decrypt_attempts, 4); i += 4;
+    memcpy(&dest[i], &decrypt_failures, 4); i += 4;
+  } else {
+    return 0;   // unknown section
+  }
+  return i;
+}
+
+static void printHistogram(Stream& out, const char* name, const StatsHistogram& h) {
+  out.printf("%s: n=%u max=%u [", name, h.count, h.max);
+  for (int b = 0; b < STATS_HIST_BUCKETS; b++) {
+    out.printf(b == 0 ? "%u" : " %u", h.buckets[b]);
+  }
+  out.printf("]\n");
+}
+
+static const char* drop_names[STATS_NUM_DROP_REASONS] = {
+  "rx_pool_empty", "rx_corrupt", "rx_too_big", "flood_filtered", "not_forwarded", "tx_start_fail", "tx_timeout", "tx_invalid"
+};
+
+void MeshStats::printTo(Stream& out) const {
+  out.printf("buckets(ms): <10 <50 <100 <500 <1000 <5000 <10000 >=10000\n");
+  printHistogram(out, "rx_delay_wait", rx_delay_wait);
+  char name[16];
+  for (int c = 0; c < STATS_NUM_PRI_CLASSES; c++) {
+    sprintf(name, "tx_wait_pri%d", c);
+    printHistogram(out, name, tx_queue_wait[c]);
+  }
+  printHistogram(out, "cad_busy", cad_busy);
+
+  for (int t = 0; t < STATS_NUM_PAYLOAD_TYPES; t++) {
+    if (recv_by_type[t] == 0) continue;
+    out.printf("type %d: recv=%u avg_us=%u max_us=%u\n", t, recv_by_type[t],
+               process_micros_by_type[t] / recv_by_type[t], process_max_micros_by_type[t]);
+  }
+  for (int r = 0; r < STATS_NUM_DROP_REASONS; r++) {
+    out.printf("drop %s: %u\n", drop_names[r], drops[r]);
+  }
+  out.printf("decrypt: attempts=%u failures=%u\n", decrypt_attempts, decrypt_failures);
+}
+
+}
+
+#endif
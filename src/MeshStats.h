@@ -0,0 +1,79 @@
+#pragma once
+
+#include <MeshCore.h>
+#include <Stream.h>
+
+#if MESH_STATS
+
+#if ARDUINO
+  #include <Arduino.h>
+  #define MESH_STATS_MICROS()   micros()
+#else
+  #define MESH_STATS_MICROS()   0
+#endif
+
+namespace mesh {
+
+#define STATS_HIST_BUCKETS     8     // upper bounds: 10, 50, 100, 500, 1000, 5000, 10000, (inf)
+#define STATS_NUM_PRI_CLASSES  4     // outbound priority classes: 0, 1-2, 3-5, 6+
+#define STATS_NUM_PAYLOAD_TYPES  16
+
+#define STATS_DROP_RX_POOL_EMPTY    0
+#define STATS_DROP_RX_CORRUPT       1
+#define STATS_DROP_RX_TOO_BIG       2
+#define STATS_DROP_FLOOD_FILTERED   3    // by filterRecvFloodPacket()
+#define STATS_DROP_NOT_FORWARDED    4    // by allowPacketForward()
+#define STATS_DROP_TX_START_FAIL    5
+#define STATS_DROP_TX_TIMEOUT       6
+#define STATS_DROP_TX_INVALID       7
+#define STATS_NUM_DROP_REASONS      8
+
+#define STATS_SECTION_QUEUES      0   // rx delay, tx wait, CAD busy histograms
+#define STATS_SECTION_TYPES       1   // per payload type counters
+#define STATS_SECTION_DROPS       2   // drop reasons, decrypt attempts
+
+/**
+ * \brief  Fixed-bucket histogram, of durations in milliseconds (or micros, per caller)
+ */
+struct StatsHistogram {
+  uint32_t buckets[STATS_HIST_BUCKETS];
+  uint32_t count, max;
+
+  void add(uint32_t value);
+  uint32_t getBucketBound(int i) const;
+};
+
+/**
+ * \brief  Optional (compile with -D MESH_STATS=1) instrumentation of the Dispatcher/Mesh hot paths.
+ */
+struct MeshStats {
+  StatsHistogram rx_delay_wait;                          // millis in delayed inbound queue
+  StatsHistogram tx_queue_wait[STATS_NUM_PRI_CLASSES];   // millis outbound packet waited, past its scheduled time
+  StatsHistogram cad_busy;                               // millis of each channel-busy (LBT) episode
+  uint32_t recv_by_type[STATS_NUM_PAYLOAD_TYPES];
+  uint32_t process_micros_by_type[STATS_NUM_PAYLOAD_TYPES];   // total time spent in onRecvPacket()
+  uint32_t process_max_micros_by_type[STATS_NUM_PAYLOAD_TYPES];
+  uint32_t drops[STATS_NUM_DROP_REASONS];
+  uint32_t decrypt_attempts;     // MAC checks, ie. one per candidate peer/channel
+  uint32_t decrypt_failures;     // MAC checks which failed (ie. wrong peer/channel, or corrupt)
+
+  MeshStats() { reset(); }
+  void reset();
+
+  static int getPriorityClass(uint8_t priority);
+
+  /**
+   * \brief  serialise one of the STATS_SECTION_* (counts are saturated to uint16)
+   * \returns  number of bytes written
+   */
+  int writeSection(uint8_t section, uint8_t* dest, int max_len) const;
+
+  /**
+   * \brief  print all stats as text lines
+   */
+  void printTo(Stream& out) const;
+};
+
+}
+
+#endif
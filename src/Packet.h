@@ -31,6 +31,10 @@ namespace mesh {
 //...
 #define PAYLOAD_TYPE_RAW_CUSTOM   0x0F    // custom packet as raw bytes, for applications with custom encryption, payloads, etc
 
+// PAYLOAD_TYPE_MULTIPART, sub-types (lower 4-bits of payload[0]), in addition to PAYLOAD_TYPE_ACK
+#define MULTIPART_TYPE_BULK_DATA  0x0C    // fragment of a bulk transfer (prefixed with dest/src hashes, MAC) (enc data: xfer_id, seq, total, len, tx_count, blob)
+#define MULTIPART_TYPE_BULK_ACK   0x0D    // selective ACK of a bulk transfer (prefixed with dest/src hashes, MAC) (enc data: xfer_id, bitmap, ack_seq)
+
 #define PAYLOAD_VER_1       0x00   // 1-byte src/dest hashes, 2-byte MAC
 #define PAYLOAD_VER_2       0x01   // FUTURE (eg. 2-byte hashes, 4-byte MAC ??)
 #define PAYLOAD_VER_3       0x02   // FUTURE
@@ -49,6 +53,12 @@ public:
   uint8_t path[MAX_PATH_SIZE];
   uint8_t payload[MAX_PACKET_PAYLOAD];
   int8_t _snr;
+  int16_t _rssi;         // dBm, when received
+  uint8_t _radio_idx;    // Dispatcher radio this was received on, or is queued to send on
+#if MESH_STATS
+  uint32_t _queued_at;   // millis when inbound queued, or when outbound was scheduled for
+  uint8_t _queued_pri;
+#endif
 
   /**
    * \brief calculate the hash of payload + type
@@ -80,6 +90,7 @@ public:
   bool isMarkedDoNotRetransmit() const { return header == 0xFF; }
 
   float getSNR() const { return ((float)_snr) / 4.0f; }
+  float getRSSI() const { return (float)_rssi; }
 
   /**
    * \returns  the encoded/wire format length of this packet
@@ -205,6 +205,43 @@ void BaseChatMesh::onPeerDataRecv(mesh::Packet* packet, uint8_t type, int sender
       uint32_t ack_hash;    // calc truncated hash of the message timestamp + text + OUR pub_key, to prove to sender that we got it
       mesh::Utils::sha256((uint8_t *) &ack_hash, 4, data, 9 + strlen((char *)&data[9]), self_id.pub_key, PUB_KEY_SIZE);
 
+      if (packet->isRouteFlood()) {
+        // let this sender know path TO here, so they can use sendDirect(), and ALSO encode the ACK
+        mesh::Packet* path = createPathReturn(from.id, secret, packet->path, packet->path_len,
+                                                PAYLOAD_TYPE_ACK, (uint8_t *) &ack_hash, 4);
+        if (path) sendFloodScoped(from, path, TXT_ACK_DELAY);
+      } else {
+        sendAckTo(from, ack_hash);
+      }
+    } else if (flags == TXT_TYPE_MULTI_POST) {
+      // find end of last whole entry (rest is cipher padding, ie. zeroes)
+      size_t end = 5;
+      while (end + 9 <= len && memcmp(&data[end], "\0\0\0\0", 4) != 0 && end + 9 + data[end + 8] <= len) {
+        end += 9 + data[end + 8];
+      }
+      if (end == 5) {
+        MESH_DEBUG_PRINTLN("onPeerDataRecv: empty multi-post");
+        return;
+      }
+      from.lastmod = getRTCClock()->getCurrentTime(); // update last heard time
+
+      for (size_t i = 5; i < end; ) {
+        uint32_t post_timestamp;
+        memcpy(&post_timestamp, &data[i], 4);
+        if (post_timestamp > from.sync_since) {  // make sure 'sync_since' is up-to-date
+          from.sync_since = post_timestamp;
+        }
+        int text_len = data[i + 8];
+        char text[MAX_PACKET_PAYLOAD];
+        memcpy(text, &data[i + 9], text_len);
+        text[text_len] = 0;
+        onSignedMessageRecv(from, packet, post_timestamp, &data[i + 4], text);  // let UI know, for each post
+        i += 9 + text_len;
+      }
+
+      uint32_t ack_hash;    // ONE ack for all posts: truncated hash of whole message + OUR pub_key
+      mesh::Utils::sha256((uint8_t *) &ack_hash, 4, data, end, self_id.pub_key, PUB_KEY_SIZE);
+
       if (packet->isRouteFlood()) {
         // let this sender know path TO here, so they can use sendDirect(), and ALSO encode the ACK
         mesh::Packet* path = createPathReturn(from.id, secret, packet->path, packet->path_len,
@@ -246,6 +283,15 @@ void BaseChatMesh::onPeerDataRecv(mesh::Packet* packet, uint8_t type, int sender
   }
 }
 
+void BaseChatMesh::onPeerMultipartRecv(mesh::Packet* packet, uint8_t type, int sender_idx, const uint8_t* secret, uint8_t* data, size_t len) {
+  int i = matching_peer_indexes[sender_idx];
+  if (i < 0 || i >= num_contacts) {
+    MESH_DEBUG_PRINTLN("onPeerMultipartRecv: Invalid sender idx: %d", i);
+    return;
+  }
+  onContactMultipartRecv(contacts[i], type, secret, data, len);
+}
+
 bool BaseChatMesh::onPeerPathRecv(mesh::Packet* packet, int sender_idx, const uint8_t* secret, uint8_t* path, uint8_t path_len, uint8_t extra_type, uint8_t* extra, uint8_t extra_len) {
   int i = matching_peer_indexes[sender_idx];
   if (i < 0 || i >= num_contacts) {
@@ -448,14 +494,16 @@ int BaseChatMesh::sendLogin(const ContactInfo& recipient, const char* password,
   mesh::Packet* pkt;
   {
     int tlen;
-    uint8_t temp[24];
+    uint8_t temp[26];
     uint32_t now = getRTCClock()->getCurrentTimeUnique();
     memcpy(temp, &now, 4);   // mostly an extra blob to help make packet_hash unique
     if (recipient.type == ADV_TYPE_ROOM) {
       memcpy(&temp[4], &recipient.sync_since, 4);
       int len = strlen(password); if (len > 15) len = 15;  // max 15 chars currently
       memcpy(&temp[8], password, len);
-      tlen = 8 + len;
+      temp[8 + len] = 0;   // null terminator, then caps byte
+      temp[9 + len] = LOGIN_CAP_MULTI_POST;
+      tlen = 10 + len;
     } else {
       int len = strlen(password); if (len > 15) len = 15;  // max 15 chars currently
       memcpy(&temp[4], password, len);
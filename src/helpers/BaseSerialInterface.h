@@ -4,6 +4,10 @@
 
 #define MAX_FRAME_SIZE  172
 
+// first byte of a write which packs multiple frames, each as: [len (1 byte)][frame bytes]
+//   (never a valid first byte of a single frame, ie. not a RESP_CODE_* or PUSH_CODE_*)
+#define FRAME_STREAM_PACKED  0xFE
+
 class BaseSerialInterface {
 protected:
   BaseSerialInterface() { }
@@ -18,4 +22,18 @@ public:
   virtual bool isWriteBusy() const = 0;
   virtual size_t writeFrame(const uint8_t src[], size_t len) = 0;
   virtual size_t checkRecvFrame(uint8_t dest[]) = 0;
+
+  /**
+   * \brief  enables packing of multiple queued frames into each underlying write (FRAME_STREAM_PACKED),
+   *         for transports where the write unit can be bigger than a single frame (eg. BLE MTU)
+   * \returns  true if framed-stream mode is now active
+   */
+  virtual bool setFramedStream(bool enable) { return false; }   // not supported by default
+
+  /**
+   * \brief  marks the start/end of a reply which spans several loop() passes (eg. the contacts iterator).
+   *         Transports with multiple clients send the whole reply to the client which started it, and hold back
+   *         commands from other clients until it ends.
+   */
+  virtual void setReplyStream(bool active) { }   // single client transports don't care
 };
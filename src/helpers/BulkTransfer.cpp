@@ -0,0 +1,247 @@
+#include "BulkTransfer.h"
+
+static int countBits(uint32_t mask) {
+  int n = 0;
+  while (mask) { mask &= mask - 1; n++; }
+  return n;
+}
+
+static uint32_t allFragsMask(int num_frags) {
+  return num_frags >= 32 ? 0xFFFFFFFF : ((uint32_t)1 << num_frags) - 1;
+}
+
+bool BulkTransferManager::startSend(const mesh::Identity& dest, const uint8_t* secret, const uint8_t* path, uint8_t path_len, const uint8_t* data, size_t len, uint16_t& xfer_id) {
+  if (len == 0 || len > BULK_MAX_TRANSFER_SIZE || path_len > MAX_PATH_SIZE) return false;
+
+  for (int i = 0; i < BULK_MAX_SEND_TRANSFERS; i++) {
+    SendTransfer& x = send_xfers[i];
+    if (x.active) continue;
+
+    x.dest = dest;
+    memcpy(x.secret, secret, PUB_KEY_SIZE);
+    memcpy(x.path, path, x.path_len = path_len);
+    x.data = data;
+    x.len = len;
+    x.num_frags = (len + BULK_FRAG_DATA_SIZE - 1) / BULK_FRAG_DATA_SIZE;
+    x.tx_count = x.retries = 0;
+    x.acked_mask = x.in_flight_mask = 0;
+    x.ack_timeout = 0;
+    x.xfer_id = xfer_id = _mesh->getRNG()->nextInt(1, 0xFFFF);
+    x.active = true;
+    return true;
+  }
+  return false;  // all slots busy
+}
+
+void BulkTransferManager::cancelSend(uint16_t xfer_id) {
+  for (int i = 0; i < BULK_MAX_SEND_TRANSFERS; i++) {
+    if (send_xfers[i].active && send_xfers[i].xfer_id == xfer_id) {
+      send_xfers[i].active = false;
+    }
+  }
+}
+
+bool BulkTransferManager::isSendActive(uint16_t xfer_id) const {
+  for (int i = 0; i < BULK_MAX_SEND_TRANSFERS; i++) {
+    if (send_xfers[i].active && send_xfers[i].xfer_id == xfer_id) return true;
+  }
+  return false;
+}
+
+void BulkTransferManager::sendFragment(SendTransfer& x, int seq) {
+  int offset = seq * BULK_FRAG_DATA_SIZE;
+  int frag_len = x.len - offset;
+  if (frag_len > BULK_FRAG_DATA_SIZE) frag_len = BULK_FRAG_DATA_SIZE;
+
+  uint8_t buf[BULK_FRAG_HEADER_SIZE + BULK_FRAG_DATA_SIZE];
+  int i = 0;
+  memcpy(&buf[i], &x.xfer_id, 2); i += 2;
+  buf[i++] = seq;
+  buf[i++] = x.num_frags;
+  buf[i++] = frag_len;
+  buf[i++] = x.tx_count++;   // NOTE: so that re-sends have a different packet hash
+  memcpy(&buf[i], &x.data[offset], frag_len); i += frag_len;
+
+  mesh::Packet* pkt = _mesh->createMultipartDatagram(MULTIPART_TYPE_BULK_DATA, x.dest, x.secret, buf, i);
+  if (pkt) {
+    int pkt_len = pkt->getRawLength() + x.path_len;   // path not set yet
+    _mesh->sendDirect(pkt, x.path, x.path_len);
+    x.in_flight_mask |= ((uint32_t)1 << seq);
+
+    // (re)start timeout, to cover all fragments now in flight
+    x.ack_timeout = _mesh->futureMillis(_host->calcBulkTimeoutMillisFor(pkt_len, countBits(x.in_flight_mask), x.path_len));
+  }
+}
+
+void BulkTransferManager::sendAck(RecvTransfer& x) {
+  uint8_t buf[7];
+  int i = 0;
+  memcpy(&buf[i], &x.xfer_id, 2); i += 2;
+  memcpy(&buf[i], &x.recv_mask, 4); i += 4;
+  buf[i++] = x.ack_seq++;   // NOTE: so that repeated ACKs have a different packet hash
+
+  mesh::Packet* pkt = _mesh->createMultipartDatagram(MULTIPART_TYPE_BULK_ACK, x.sender, x.secret, buf, i);
+  if (pkt) {
+    _mesh->sendDirect(pkt, x.path, x.path_len);
+  }
+  x.unacked = 0;
+  x.ack_due = 0;
+}
+
+BulkTransferManager::RecvTransfer* BulkTransferManager::allocRecvTransfer() {
+  RecvTransfer* oldest = NULL;
+  for (int i = 0; i < BULK_MAX_RECV_TRANSFERS; i++) {
+    RecvTransfer* x = &recv_xfers[i];
+    if (!x->active) return x;
+    if (x->delivered && (oldest == NULL || (long)(x->expiry - oldest->expiry) < 0)) oldest = x;
+  }
+  return oldest;   // can only evict completed transfers (which are just lingering to re-ACK)
+}
+
+void BulkTransferManager::onDataRecv(const mesh::Identity& sender, const uint8_t* secret, const uint8_t* out_path, uint8_t out_path_len,
+                                     const uint8_t* data, size_t len) {
+  if (len < BULK_FRAG_HEADER_SIZE || recv_xfers[0].buf == NULL) return;   // too short, or send-only
+
+  int i = 0;
+  uint16_t xfer_id;
+  memcpy(&xfer_id, &data[i], 2); i += 2;
+  uint8_t seq = data[i++];
+  uint8_t total = data[i++];
+  uint8_t frag_len = data[i++];
+  i++;  // tx_count (not needed)
+
+  if (total == 0 || total > BULK_MAX_FRAGMENTS || seq >= total || frag_len > BULK_FRAG_DATA_SIZE || i + frag_len > len
+     || (seq < total - 1 && frag_len != BULK_FRAG_DATA_SIZE)) {
+    MESH_DEBUG_PRINTLN("BulkTransferManager: invalid fragment, seq=%d, total=%d, len=%d", (uint32_t)seq, (uint32_t)total, (uint32_t)frag_len);
+    return;
+  }
+
+  RecvTransfer* x = NULL;
+  for (int k = 0; k < BULK_MAX_RECV_TRANSFERS; k++) {
+    if (recv_xfers[k].active && recv_xfers[k].xfer_id == xfer_id && recv_xfers[k].sender.matches(sender)) {
+      x = &recv_xfers[k];
+      break;
+    }
+  }
+  if (x == NULL) {
+    x = allocRecvTransfer();
+    if (x == NULL) {
+      MESH_DEBUG_PRINTLN("BulkTransferManager: no free recv slots");
+      return;   // sender will retry later
+    }
+    x->sender = sender;
+    memcpy(x->secret, secret, PUB_KEY_SIZE);
+    x->xfer_id = xfer_id;
+    x->num_frags = total;
+    x->last_frag_len = 0;
+    x->recv_mask = 0;
+    x->unacked = x->ack_seq = 0;
+    x->ack_due = 0;
+    x->delivered = false;
+    x->active = true;
+  } else if (total != x->num_frags) {
+    return;  // inconsistent
+  }
+  memcpy(x->path, out_path, x->path_len = out_path_len);   // latest path back to sender
+  x->expiry = _mesh->futureMillis(BULK_RECV_EXPIRY_MILLIS);
+
+  uint32_t bit = (uint32_t)1 << seq;
+  if ((x->recv_mask & bit) == 0) {
+    memcpy(&x->buf[seq * BULK_FRAG_DATA_SIZE], &data[i], frag_len);
+    if (seq == total - 1) x->last_frag_len = frag_len;
+    x->recv_mask |= bit;
+  }
+  x->unacked++;
+
+  if (x->recv_mask == allFragsMask(x->num_frags)) {
+    if (!x->delivered) {
+      x->delivered = true;
+      _host->onBulkRecvComplete(x->sender, x->xfer_id, x->buf, (x->num_frags - 1) * BULK_FRAG_DATA_SIZE + x->last_frag_len);
+    }
+    sendAck(*x);   // final ACK now (also re-ACKs retransmits, in case our ACK was lost)
+  } else if (x->unacked >= BULK_WINDOW_SIZE) {
+    sendAck(*x);
+  } else if (x->ack_due == 0) {
+    x->ack_due = _mesh->futureMillis(BULK_ACK_DELAY_MILLIS);
+  }
+}
+
+void BulkTransferManager::onAckRecv(const mesh::Identity& sender, const uint8_t* data, size_t len) {
+  if (len < 6) return;
+
+  uint16_t xfer_id;
+  memcpy(&xfer_id, data, 2);
+  uint32_t bitmap;
+  memcpy(&bitmap, &data[2], 4);
+
+  for (int i = 0; i < BULK_MAX_SEND_TRANSFERS; i++) {
+    SendTransfer& x = send_xfers[i];
+    if (!x.active || x.xfer_id != xfer_id || !x.dest.matches(sender)) continue;
+
+    bitmap &= allFragsMask(x.num_frags);
+    if (bitmap & ~x.acked_mask) {   // progress made
+      // any still in flight, BELOW the highest fragment this ACK covers (of those in flight), are presumed lost (re-send now)
+      uint32_t newly = bitmap & x.in_flight_mask;
+      uint32_t below = 0;
+      for (int seq = x.num_frags - 1; seq >= 0; seq--) {
+        if (newly & ((uint32_t)1 << seq)) { below = ((uint32_t)1 << seq) - 1; break; }
+      }
+      x.acked_mask |= bitmap;
+      x.in_flight_mask &= ~(x.acked_mask | below);
+      x.retries = 0;
+    }
+
+    if (x.acked_mask == allFragsMask(x.num_frags)) {
+      x.active = false;
+      _host->onBulkSendComplete(x.xfer_id, true);
+    }
+    break;
+  }
+}
+
+void BulkTransferManager::onMultipartRecv(uint8_t type, const mesh::Identity& sender, const uint8_t* secret, const uint8_t* out_path, uint8_t out_path_len,
+                                          const uint8_t* data, size_t len) {
+  if (type == MULTIPART_TYPE_BULK_DATA) {
+    onDataRecv(sender, secret, out_path, out_path_len, data, len);
+  } else if (type == MULTIPART_TYPE_BULK_ACK) {
+    onAckRecv(sender, data, len);
+  }
+}
+
+void BulkTransferManager::loop() {
+  for (int i = 0; i < BULK_MAX_SEND_TRANSFERS; i++) {
+    SendTransfer& x = send_xfers[i];
+    if (!x.active) continue;
+
+    if (x.in_flight_mask && _mesh->millisHasNowPassed(x.ack_timeout)) {
+      if (++x.retries > BULK_MAX_RETRIES) {
+        MESH_DEBUG_PRINTLN("BulkTransferManager: transfer %d timed out", (uint32_t)x.xfer_id);
+        x.active = false;
+        _host->onBulkSendComplete(x.xfer_id, false);
+        continue;
+      }
+      x.in_flight_mask = 0;   // re-send all un-ACKed
+    }
+
+    // fill the window with un-ACKed fragments, not already in flight
+    for (int seq = 0; seq < x.num_frags && countBits(x.in_flight_mask) < BULK_WINDOW_SIZE; seq++) {
+      uint32_t bit = (uint32_t)1 << seq;
+      if ((x.acked_mask & bit) == 0 && (x.in_flight_mask & bit) == 0) {
+        sendFragment(x, seq);
+        if ((x.in_flight_mask & bit) == 0) break;   // packet pool empty, try again next loop
+      }
+    }
+  }
+
+  for (int i = 0; i < BULK_MAX_RECV_TRANSFERS; i++) {
+    RecvTransfer& x = recv_xfers[i];
+    if (!x.active) continue;
+
+    if (x.ack_due && _mesh->millisHasNowPassed(x.ack_due)) {
+      sendAck(x);
+    }
+    if (_mesh->millisHasNowPassed(x.expiry)) {
+      x.active = false;
+    }
+  }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <Mesh.h>
+
+#ifndef BULK_MAX_FRAGMENTS
+  #define BULK_MAX_FRAGMENTS       16    // per transfer, max 32 (size of ACK bitmap)
+#endif
+
+#ifndef BULK_MAX_SEND_TRANSFERS
+  #define BULK_MAX_SEND_TRANSFERS   2
+#endif
+
+#ifndef BULK_MAX_RECV_TRANSFERS
+  #define BULK_MAX_RECV_TRANSFERS   1
+#endif
+
+#ifndef BULK_WINDOW_SIZE
+  #define BULK_WINDOW_SIZE          4    // max fragments in flight, per transfer
+#endif
+
+#ifndef BULK_MAX_RETRIES
+  #define BULK_MAX_RETRIES          4    // consecutive timeouts (with no progress) before giving up
+#endif
+
+#ifndef BULK_ACK_DELAY_MILLIS
+  #define BULK_ACK_DELAY_MILLIS   800    // how long receiver waits for more fragments, before sending a (partial) ACK
+#endif
+
+#define BULK_RECV_EXPIRY_MILLIS  60000   // recv slot is freed this long after last fragment
+
+#define BULK_FRAG_HEADER_SIZE     6      // xfer_id(2), seq, total, len, tx_count
+#define BULK_FRAG_DATA_SIZE      (176 - BULK_FRAG_HEADER_SIZE)   // 176 = max block-aligned plaintext in a MULTIPART datagram
+#define BULK_MAX_TRANSFER_SIZE   (BULK_MAX_FRAGMENTS * BULK_FRAG_DATA_SIZE)
+#define BULK_RECV_BUFFER_SIZE    (BULK_MAX_RECV_TRANSFERS * BULK_MAX_TRANSFER_SIZE)   // for BulkTransferManager(.., recv_buf)
+
+class BulkTransferHost {
+public:
+  /**
+   * \returns  milliseconds to wait for an ACK after sending 'num_pkts' packets of 'pkt_len' bytes along a path of 'path_len'.
+   *           (eg. calcDirectTimeoutMillisFor() on the combined airtime)
+   */
+  virtual uint32_t calcBulkTimeoutMillisFor(int pkt_len, int num_pkts, uint8_t path_len) = 0;
+
+  /**
+   * \brief  all fragments of an incoming transfer have been received. (called just once per transfer)
+   *         NOTE: 'data' stays valid until its slot is taken by another incoming transfer
+   */
+  virtual void onBulkRecvComplete(const mesh::Identity& sender, uint16_t xfer_id, const uint8_t* data, size_t len) = 0;
+
+  /**
+   * \brief  an outgoing transfer has finished, either all ACKed or timed out. The 'data' buffer may now be reused.
+   */
+  virtual void onBulkSendComplete(uint16_t xfer_id, bool success) { }
+};
+
+/**
+ * \brief  Fragmentation/reassembly of large Direct datagrams, using PAYLOAD_TYPE_MULTIPART packets.
+ *         Fragments are sent with a sliding window, and receiver sends back selective ACK bitmaps.
+ *         The Mesh sub-class forwards its onPeerMultipartRecv() calls to onMultipartRecv(), and calls loop().
+ */
+class BulkTransferManager {
+  struct SendTransfer {
+    mesh::Identity dest;
+    uint8_t secret[PUB_KEY_SIZE];
+    uint8_t path[MAX_PATH_SIZE];
+    uint8_t path_len;
+    const uint8_t* data;   // NOTE: owned by caller
+    uint16_t len;
+    uint16_t xfer_id;
+    uint8_t num_frags;
+    uint8_t tx_count, retries;
+    uint32_t acked_mask, in_flight_mask;
+    unsigned long ack_timeout;
+    bool active;
+  };
+
+  struct RecvTransfer {
+    mesh::Identity sender;
+    uint8_t secret[PUB_KEY_SIZE];
+    uint8_t path[MAX_PATH_SIZE];
+    uint8_t path_len;
+    uint16_t xfer_id;
+    uint8_t num_frags;
+    uint8_t last_frag_len;
+    uint8_t unacked, ack_seq;
+    uint32_t recv_mask;
+    unsigned long ack_due, expiry;
+    bool active, delivered;
+    uint8_t* buf;   // BULK_MAX_TRANSFER_SIZE bytes, of the owner's recv_buf
+  };
+
+  mesh::Mesh* _mesh;
+  BulkTransferHost* _host;
+  SendTransfer send_xfers[BULK_MAX_SEND_TRANSFERS];
+  RecvTransfer recv_xfers[BULK_MAX_RECV_TRANSFERS];
+
+  void sendFragment(SendTransfer& x, int seq);
+  void sendAck(RecvTransfer& x);
+  void onDataRecv(const mesh::Identity& sender, const uint8_t* secret, const uint8_t* out_path, uint8_t out_path_len, const uint8_t* data, size_t len);
+  void onAckRecv(const mesh::Identity& sender, const uint8_t* data, size_t len);
+  RecvTransfer* allocRecvTransfer();
+
+public:
+  /**
+   * \param  recv_buf  BULK_RECV_BUFFER_SIZE bytes for reassembly, or NULL if only sending (incoming transfers are ignored)
+   */
+  BulkTransferManager(mesh::Mesh& mesh, BulkTransferHost& host, uint8_t* recv_buf) : _mesh(&mesh), _host(&host) {
+    memset(send_xfers, 0, sizeof(send_xfers));
+    for (int i = 0; i < BULK_MAX_RECV_TRANSFERS; i++) {
+      recv_xfers[i].active = false;
+      recv_xfers[i].buf = recv_buf ? &recv_buf[i * BULK_MAX_TRANSFER_SIZE] : NULL;
+    }
+  }
+
+  /**
+   * \brief  start sending 'data' to 'dest' along given (Direct) path.
+   * \param  data   must remain valid until onBulkSendComplete()
+   * \param  xfer_id  (OUT) id of the new transfer
+   * \returns  false if too big, or no free transfer slots
+   */
+  bool startSend(const mesh::Identity& dest, const uint8_t* secret, const uint8_t* path, uint8_t path_len, const uint8_t* data, size_t len, uint16_t& xfer_id);
+  void cancelSend(uint16_t xfer_id);
+  bool isSendActive(uint16_t xfer_id) const;
+
+  /**
+   * \brief  handle a received MULTIPART_TYPE_BULK_* packet (via Mesh::onPeerMultipartRecv())
+   * \param  out_path  the Direct path back to sender (for the ACKs)
+   */
+  void onMultipartRecv(uint8_t type, const mesh::Identity& sender, const uint8_t* secret, const uint8_t* out_path, uint8_t out_path_len, const uint8_t* data, size_t len);
+
+  void loop();
+};
@@ -21,10 +21,11 @@ struct ClientInfo {
   union  {
     struct {
       uint32_t sync_since;  // sync messages SINCE this timestamp (by OUR clock)
-      uint32_t pending_ack;
-      uint32_t push_post_timestamp;
-      unsigned long ack_timeout;
+      uint32_t sync_seq;    // cursor: sequence number of first post after sync_since  (transient)
+      uint32_t push_seq;    // cursor: sequence number of next post to consider pushing  (transient)
+      uint16_t own_since;   // number of this client's own posts from sync_seq onwards  (transient)
       uint8_t  push_failures;
+      uint8_t  login_caps;   // optional push formats, agreed at login
     } room;
   } extra;
   
@@ -70,7 +70,10 @@ void CommonCLI::loadPrefsInt(FILESYSTEM* fs, const char* filename) {
     file.read((uint8_t *)&_prefs->gps_interval, sizeof(_prefs->gps_interval));                     // 157
     file.read((uint8_t *)&_prefs->advert_loc_policy, sizeof (_prefs->advert_loc_policy));          // 161
     file.read((uint8_t *)&_prefs->discovery_mod_timestamp, sizeof(_prefs->discovery_mod_timestamp)); // 162
-    // 166
+    file.read((uint8_t *)&_prefs->flood_snr_slots, sizeof(_prefs->flood_snr_slots));               // 166
+    file.read((uint8_t *)&_prefs->flood_gossip, sizeof(_prefs->flood_gossip));                     // 167
+    file.read((uint8_t *)&_prefs->flood_rate_limit, sizeof(_prefs->flood_rate_limit));             // 168
+    // 169
 
     // sanitise bad pref values
     _prefs->rx_delay_base = constrain(_prefs->rx_delay_base, 0, 20.0f);
@@ -83,6 +86,9 @@ void CommonCLI::loadPrefsInt(FILESYSTEM* fs, const char* filename) {
     _prefs->cr = constrain(_prefs->cr, 5, 8);
     _prefs->tx_power_dbm = constrain(_prefs->tx_power_dbm, 1, 30);
     _prefs->multi_acks = constrain(_prefs->multi_acks, 0, 1);
+    _prefs->flood_snr_slots = constrain(_prefs->flood_snr_slots, 0, 16);
+    _prefs->flood_gossip = constrain(_prefs->flood_gossip, 0, 1);
+    _prefs->flood_rate_limit = constrain(_prefs->flood_rate_limit, 0, 1);
 
     // sanitise bad bridge pref values
     _prefs->bridge_enabled = constrain(_prefs->bridge_enabled, 0, 1);
@@ -148,7 +154,10 @@ void CommonCLI::savePrefs(FILESYSTEM* fs) {
     file.write((uint8_t *)&_prefs->gps_interval, sizeof(_prefs->gps_interval));                     // 157
     file.write((uint8_t *)&_prefs->advert_loc_policy, sizeof(_prefs->advert_loc_policy));           // 161
     file.write((uint8_t *)&_prefs->discovery_mod_timestamp, sizeof(_prefs->discovery_mod_timestamp)); // 162
-    // 166
+    file.write((uint8_t *)&_prefs->flood_snr_slots, sizeof(_prefs->flood_snr_slots));               // 166
+    file.write((uint8_t *)&_prefs->flood_gossip, sizeof(_prefs->flood_gossip));                     // 167
+    file.write((uint8_t *)&_prefs->flood_rate_limit, sizeof(_prefs->flood_rate_limit));             // 168
+    // 169
 
     file.close();
   }
@@ -211,8 +220,12 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, const char* command, ch
       } else {
         strcpy(reply, "(ERR: clock cannot go backwards)");
       }
+    } else if (memcmp(command, "neighbors.link", 14) == 0) {
+      _callbacks->formatNeighborLinksReply(reply);
     } else if (memcmp(command, "neighbors", 9) == 0) {
       _callbacks->formatNeighborsReply(reply);
+    } else if (memcmp(command, "throttled", 9) == 0) {
+      _callbacks->formatThrottledReply(reply);
     } else if (memcmp(command, "neighbor.remove ", 16) == 0) {
       const char* hex = &command[16];
       uint8_t pubkey[PUB_KEY_SIZE];
@@ -292,6 +305,12 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, const char* command, ch
         sprintf(reply, "> %s", StrHelper::ftoa(_prefs->tx_delay_factor));
       } else if (memcmp(config, "flood.max", 9) == 0) {
         sprintf(reply, "> %d", (uint32_t)_prefs->flood_max);
+      } else if (memcmp(config, "flood.slots", 11) == 0) {
+        sprintf(reply, "> %d", (uint32_t)_prefs->flood_snr_slots);
+      } else if (memcmp(config, "flood.gossip", 12) == 0) {
+        sprintf(reply, "> %s", _prefs->flood_gossip ? "on" : "off");
+      } else if (memcmp(config, "flood.ratelimit", 15) == 0) {
+        sprintf(reply, "> %s", _prefs->flood_rate_limit ? "on" : "off");
       } else if (memcmp(config, "direct.txdelay", 14) == 0) {
         sprintf(reply, "> %s", StrHelper::ftoa(_prefs->direct_tx_delay_factor));
       } else if (memcmp(config, "tx", 2) == 0 && (config[2] == 0 || config[2] == ' ')) {
@@ -309,6 +328,8 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, const char* command, ch
                 "rs232"
 #elif WITH_ESPNOW_BRIDGE
                 "espnow"
+#elif WITH_IP_BRIDGE
+                "ip"
 #else
                 "none"
 #endif
@@ -328,6 +349,8 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, const char* command, ch
 #ifdef WITH_ESPNOW_BRIDGE
       } else if (memcmp(config, "bridge.channel", 14) == 0) {
         sprintf(reply, "> %d", (uint32_t)_prefs->bridge_channel);
+#endif
+#if defined(WITH_ESPNOW_BRIDGE) || defined(WITH_IP_BRIDGE)
       } else if (memcmp(config, "bridge.secret", 13) == 0) {
         sprintf(reply, "> %s", _prefs->bridge_secret);
 #endif
@@ -456,6 +479,31 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, const char* command, ch
         } else {
           strcpy(reply, "Error, max 64");
         }
+      } else if (memcmp(config, "flood.slots ", 12) == 0) {
+        int n = atoi(&config[12]);   // NOTE: range check before narrowing
+        if (n >= 0 && n <= 16) {
+          _prefs->flood_snr_slots = n;
+          savePrefs();
+          strcpy(reply, "OK");
+        } else {
+          strcpy(reply, "Error, max 16");
+        }
+      } else if (memcmp(config, "flood.gossip ", 13) == 0) {
+        if (memcmp(&config[13], "on", 2) == 0 || memcmp(&config[13], "off", 3) == 0) {
+          _prefs->flood_gossip = memcmp(&config[13], "on", 2) == 0;
+          savePrefs();
+          strcpy(reply, "OK");
+        } else {
+          strcpy(reply, "Error, must be on or off");
+        }
+      } else if (memcmp(config, "flood.ratelimit ", 16) == 0) {
+        if (memcmp(&config[16], "on", 2) == 0 || memcmp(&config[16], "off", 3) == 0) {
+          _prefs->flood_rate_limit = memcmp(&config[16], "on", 2) == 0;
+          savePrefs();
+          strcpy(reply, "OK");
+        } else {
+          strcpy(reply, "Error, must be on or off");
+        }
       } else if (memcmp(config, "direct.txdelay ", 15) == 0) {
         float f = atof(&config[15]);
         if (f >= 0) {
@@ -517,6 +565,8 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, const char* command, ch
         } else {
           strcpy(reply, "Error: channel must be between 1-14");
         }
+#endif
+#if defined(WITH_ESPNOW_BRIDGE) || defined(WITH_IP_BRIDGE)
       } else if (memcmp(config, "bridge.secret ", 14) == 0) {
         StrHelper::strncpy(_prefs->bridge_secret, &config[14], sizeof(_prefs->bridge_secret));
         _callbacks->restartBridge();
@@ -671,6 +721,12 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, const char* command, ch
       _callbacks->formatRadioStatsReply(reply);
     } else if (sender_timestamp == 0 && memcmp(command, "stats-core", 10) == 0 && (command[10] == 0 || command[10] == ' ')) {
       _callbacks->formatStatsReply(reply);
+    } else if (sender_timestamp == 0 && memcmp(command, "stats-detail", 12) == 0 && (command[12] == 0 || command[12] == ' ')) {
+      if (_callbacks->dumpDetailStats()) {
+        strcpy(reply, "   EOF");
+      } else {
+        strcpy(reply, "Err - not enabled (needs MESH_STATS build)");
+      }
     } else {
       strcpy(reply, "Unknown command");
     }
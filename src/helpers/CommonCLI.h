@@ -4,7 +4,7 @@
 #include <helpers/IdentityStore.h>
 #include <helpers/SensorManager.h>
 
-#if defined(WITH_RS232_BRIDGE) || defined(WITH_ESPNOW_BRIDGE)
+#if defined(WITH_RS232_BRIDGE) || defined(WITH_ESPNOW_BRIDGE) || defined(WITH_IP_BRIDGE)
 #define WITH_BRIDGE
 #endif
 
@@ -41,12 +41,15 @@ struct NodePrefs { // persisted to file
   uint8_t bridge_pkt_src; // 0 = logTx, 1 = logRx (default logTx)
   uint32_t bridge_baud;   // 9600, 19200, 38400, 57600, 115200 (default 115200)
   uint8_t bridge_channel; // 1-14 (ESP-NOW only)
-  char bridge_secret[16]; // for XOR encryption of bridge packets (ESP-NOW only)
+  char bridge_secret[16]; // for XOR encryption (ESP-NOW), or HMAC authentication (IP) of bridge packets
   // Gps settings
   uint8_t gps_enabled;
   uint32_t gps_interval; // in seconds
   uint8_t advert_loc_policy;
   uint32_t discovery_mod_timestamp;
+  uint8_t flood_snr_slots;  // 0 = off (uniform random retransmit delay), else num SNR-ranked contention slots
+  uint8_t flood_gossip;     // boolean, forward floods with a probability adapted to local density
+  uint8_t flood_rate_limit; // boolean, per-source budgets for forwarding floods
 };
 
 class CommonCLICallbacks {
@@ -64,12 +67,21 @@ public:
   virtual void dumpLogFile() = 0;
   virtual void setTxPower(uint8_t power_dbm) = 0;
   virtual void formatNeighborsReply(char *reply) = 0;
+  virtual void formatNeighborLinksReply(char *reply) {
+    strcpy(reply, "not supported");
+  }
   virtual void removeNeighbor(const uint8_t* pubkey, int key_len) {
     // no op by default
   };
+  virtual void formatThrottledReply(char *reply) {
+    strcpy(reply, "-none-");
+  }
   virtual void formatStatsReply(char *reply) = 0;
   virtual void formatRadioStatsReply(char *reply) = 0;
   virtual void formatPacketStatsReply(char *reply) = 0;
+  virtual bool dumpDetailStats() {
+    return false;   // not supported by default
+  };
   virtual mesh::LocalIdentity& getSelfId() = 0;
   virtual void saveIdentity(const mesh::LocalIdentity& new_id) = 0;
   virtual void clearStats() = 0;
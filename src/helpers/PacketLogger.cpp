@@ -0,0 +1,219 @@
+#include "PacketLogger.h"
+#include <RTClib.h>
+
+static File openRead(FILESYSTEM* _fs, const char* filename) {
+#if defined(RP2040_PLATFORM)
+  return _fs->open(filename, "r");
+#else
+  return _fs->open(filename);
+#endif
+}
+
+static File openAppend(FILESYSTEM* _fs, const char* filename) {
+#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+  return _fs->open(filename, FILE_O_WRITE);
+#elif defined(RP2040_PLATFORM)
+  return _fs->open(filename, "a");
+#else
+  return _fs->open(filename, "a", true);
+#endif
+}
+
+void PacketLogger::segmentName(char* dest, int seg) const {
+  sprintf(dest, "%s%d", _base_name, seg);
+}
+
+bool PacketLogger::readSegmentSeq(int seg, uint32_t& seq) {
+  char name[32];
+  segmentName(name, seg);
+  if (!_fs->exists(name)) return false;
+
+  File f = openRead(_fs, name);
+  if (!f) return false;
+  bool success = f.read((uint8_t *)&seq, 4) == 4;
+  f.close();
+  return success;
+}
+
+bool PacketLogger::startSegment(int seg, uint32_t seq) {
+  char name[32];
+  segmentName(name, seg);
+  _fs->remove(name);
+
+  File f = openAppend(_fs, name);
+  if (!f) return false;
+  bool success = f.write((uint8_t *)&seq, 4) == 4;
+  f.close();
+
+  cur_seg = seg;
+  cur_seq = seq;
+  cur_size = 4;
+  return success;
+}
+
+void PacketLogger::onWriteFailed() {
+  MESH_DEBUG_PRINTLN("PacketLogger: write failed (filesystem full?), logging stopped");
+  _failed = true;
+  num_buf = 0;
+}
+
+void PacketLogger::begin(FILESYSTEM* fs) {
+  _fs = fs;
+  num_buf = 0;
+  cur_seg = -1;
+  _failed = false;
+
+  // find the newest segment, to continue appending to
+  uint32_t seq;
+  for (int i = 0; i < PACKET_LOG_NUM_SEGMENTS; i++) {
+    if (readSegmentSeq(i, seq) && (cur_seg < 0 || (int32_t)(seq - cur_seq) > 0)) {
+      cur_seg = i;
+      cur_seq = seq;
+    }
+  }
+  if (cur_seg >= 0) {
+    char name[32];
+    segmentName(name, cur_seg);
+    File f = openRead(_fs, name);
+    cur_size = f ? f.size() : 0;
+    if (f) f.close();
+
+    if (cur_size < 4 || (cur_size - 4) % sizeof(PacketLogRecord) != 0) {   // partial record from a failed write
+      cur_size = PACKET_LOG_SEGMENT_SIZE;   // so next flush() starts a new segment
+    }
+  }
+}
+
+void PacketLogger::log(uint8_t kind, const mesh::Packet* pkt, int len, uint32_t timestamp, float snr, float rssi, float score) {
+  if (_failed) return;
+  if (num_buf >= PACKET_LOG_BUF_RECORDS) flush();
+
+  PacketLogRecord* rec = &buf[num_buf++];
+  memset(rec, 0, sizeof(*rec));
+  rec->timestamp = timestamp;
+  rec->kind = kind;
+  rec->header = pkt->header;
+  rec->len = len;
+  rec->payload_len = pkt->payload_len;
+  rec->path_len = pkt->path_len;
+  rec->snr = (int8_t)(snr * 4);
+  rec->rssi = (int16_t)rssi;
+  rec->score = (int16_t)(score * 1000);
+
+  uint8_t hash[MAX_HASH_SIZE];
+  pkt->calculatePacketHash(hash);
+  memcpy(rec->hash, hash, sizeof(rec->hash));
+
+  uint8_t type = pkt->getPayloadType();
+  if (type == PAYLOAD_TYPE_PATH || type == PAYLOAD_TYPE_REQ || type == PAYLOAD_TYPE_RESPONSE || type == PAYLOAD_TYPE_TXT_MSG) {
+    rec->dest_hash = pkt->payload[0];
+    rec->src_hash = pkt->payload[1];
+  }
+
+  if (num_buf == 1) flush_due = millis() + PACKET_LOG_FLUSH_MILLIS;
+}
+
+void PacketLogger::flush() {
+  if (num_buf == 0 || _fs == NULL || _failed) return;
+
+  bool ok = true;
+  if (cur_seg < 0) {
+    ok = startSegment(0, 1);
+  } else if (cur_size + num_buf * sizeof(PacketLogRecord) > PACKET_LOG_SEGMENT_SIZE) {
+    ok = startSegment((cur_seg + 1) % PACKET_LOG_NUM_SEGMENTS, cur_seq + 1);   // rotate, overwriting oldest
+  }
+
+  if (ok) {
+    char name[32];
+    segmentName(name, cur_seg);
+    File f = openAppend(_fs, name);
+    if (f) {
+      int len = num_buf * sizeof(PacketLogRecord);
+      ok = f.write((uint8_t *)buf, len) == len;
+      f.close();
+      cur_size += len;
+    } else {
+      ok = false;
+    }
+  }
+  if (!ok) {
+    onWriteFailed();
+    return;
+  }
+  num_buf = 0;
+}
+
+void PacketLogger::loop() {
+  if (num_buf > 0 && (long)(millis() - flush_due) >= 0) {
+    flush();
+  }
+}
+
+void PacketLogger::erase() {
+  num_buf = 0;
+  char name[32];
+  for (int i = 0; i < PACKET_LOG_NUM_SEGMENTS; i++) {
+    segmentName(name, i);
+    _fs->remove(name);
+  }
+  cur_seg = -1;
+  cur_seq = 0;
+  cur_size = 0;
+  _failed = false;
+}
+
+static const char* kind_names[] = { "RX", "TX", "TX FAIL!" };
+
+void PacketLogger::dumpTo(Stream& out) {
+  flush();
+
+  // order segments by sequence number, oldest first
+  int order[PACKET_LOG_NUM_SEGMENTS];
+  uint32_t seqs[PACKET_LOG_NUM_SEGMENTS];
+  int n = 0;
+  for (int i = 0; i < PACKET_LOG_NUM_SEGMENTS; i++) {
+    uint32_t seq;
+    if (!readSegmentSeq(i, seq)) continue;
+
+    int j = n++;
+    while (j > 0 && (int32_t)(seqs[j - 1] - seq) > 0) {   // insertion sort
+      seqs[j] = seqs[j - 1];
+      order[j] = order[j - 1];
+      j--;
+    }
+    seqs[j] = seq;
+    order[j] = i;
+  }
+
+  char name[32];
+  for (int k = 0; k < n; k++) {
+    segmentName(name, order[k]);
+    File f = openRead(_fs, name);
+    if (!f) continue;
+
+    uint32_t seq;
+    f.read((uint8_t *)&seq, 4);
+
+    PacketLogRecord rec;
+    while (f.read((uint8_t *)&rec, sizeof(rec)) == sizeof(rec)) {
+      DateTime dt = DateTime(rec.timestamp);
+      uint8_t route = rec.header & PH_ROUTE_MASK;
+      uint8_t type = (rec.header >> PH_TYPE_SHIFT) & PH_TYPE_MASK;
+      out.printf("%02d:%02d:%02d - %d/%d/%d U: %s, len=%d (type=%d, route=%s, payload_len=%d, path_len=%d)",
+                 dt.hour(), dt.minute(), dt.second(), dt.day(), dt.month(), dt.year(),
+                 kind_names[rec.kind < 3 ? rec.kind : 0], (uint32_t)rec.len, (uint32_t)type,
+                 (route == ROUTE_TYPE_DIRECT || route == ROUTE_TYPE_TRANSPORT_DIRECT) ? "D" : "F",
+                 (uint32_t)rec.payload_len, (uint32_t)rec.path_len);
+      if (rec.kind == PACKET_LOG_RX) {
+        out.printf(" SNR=%d RSSI=%d score=%d", (int)(rec.snr / 4), (int)rec.rssi, (int)rec.score);
+      }
+      out.printf(" hash=%02X%02X%02X%02X", (uint32_t)rec.hash[0], (uint32_t)rec.hash[1], (uint32_t)rec.hash[2], (uint32_t)rec.hash[3]);
+      if (type == PAYLOAD_TYPE_PATH || type == PAYLOAD_TYPE_REQ || type == PAYLOAD_TYPE_RESPONSE || type == PAYLOAD_TYPE_TXT_MSG) {
+        out.printf(" [%02X -> %02X]\n", (uint32_t)rec.src_hash, (uint32_t)rec.dest_hash);
+      } else {
+        out.printf("\n");
+      }
+    }
+    f.close();
+  }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <Arduino.h>   // needed for PlatformIO
+#include <Packet.h>
+#include <helpers/IdentityStore.h>
+
+#ifndef PACKET_LOG_BUF_RECORDS
+  #define PACKET_LOG_BUF_RECORDS     32     // records buffered in RAM, before writing a block to flash
+#endif
+
+#ifndef PACKET_LOG_FLUSH_MILLIS
+  #define PACKET_LOG_FLUSH_MILLIS    30000  // max time records sit in RAM buffer
+#endif
+
+#ifndef PACKET_LOG_NUM_SEGMENTS
+  #define PACKET_LOG_NUM_SEGMENTS    4
+#endif
+
+#ifndef PACKET_LOG_SEGMENT_SIZE
+  #if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+    #define PACKET_LOG_SEGMENT_SIZE    (2*1024)    // internal flash FS is only ~28-32KB, which prefs, ACL etc also need
+  #else
+    #define PACKET_LOG_SEGMENT_SIZE    (16*1024)
+  #endif
+#endif
+
+#define PACKET_LOG_RX        0
+#define PACKET_LOG_TX        1
+#define PACKET_LOG_TX_FAIL   2
+
+struct PacketLogRecord {   // 20 bytes, as stored in segment files
+  uint32_t timestamp;      // RTC time
+  uint8_t kind;            // PACKET_LOG_*
+  uint8_t header;          // Packet::header (route + payload type)
+  uint8_t len;             // raw length
+  uint8_t payload_len;
+  uint8_t path_len;
+  int8_t  snr;             // x 4
+  int16_t rssi;
+  int16_t score;           // x 1000
+  uint8_t hash[4];         // packet hash prefix
+  uint8_t src_hash, dest_hash;   // only for PATH, REQ, RESPONSE, TXT_MSG types
+};
+
+/**
+ * \brief  Compact binary packet log. Records are buffered in RAM and appended to flash in blocks, to a fixed set
+ *         of rotating segment files (oldest segment is overwritten when all are full).
+ *         Each segment file starts with a 4-byte sequence number, followed by records.
+ *         If a write fails (eg. filesystem full), logging stops until erase(), rather than silently losing blocks.
+ */
+class PacketLogger {
+  FILESYSTEM* _fs;
+  const char* _base_name;
+  PacketLogRecord buf[PACKET_LOG_BUF_RECORDS];
+  int num_buf;
+  int cur_seg;
+  uint32_t cur_seq, cur_size;
+  unsigned long flush_due;
+  bool _failed;
+
+  void segmentName(char* dest, int seg) const;
+  bool readSegmentSeq(int seg, uint32_t& seq);
+  bool startSegment(int seg, uint32_t seq);
+  void onWriteFailed();
+
+public:
+  PacketLogger(const char* base_name) : _fs(NULL), _base_name(base_name), num_buf(0), cur_seg(-1), cur_seq(0), cur_size(0), flush_due(0), _failed(false) { }
+
+  void begin(FILESYSTEM* fs);
+  void log(uint8_t kind, const mesh::Packet* pkt, int len, uint32_t timestamp, float snr, float rssi, float score);
+  void flush();
+  void loop();
+  void erase();
+  bool hasFailed() const { return _failed; }
+
+  /**
+   * \brief  decode all segments (oldest first) to text lines
+   */
+  void dumpTo(Stream& out);
+};
@@ -0,0 +1,34 @@
+#include "PacketScorer.h"
+
+// Approximate SNR threshold per SF for successful reception (based on Semtech datasheets)
+static const float snr_threshold[] = {
+    -2.5,  // SF5 needs at least -2.5 dB SNR
+    -5,    // SF6 needs at least -5 dB SNR
+    -7.5,  // SF7 needs at least -7.5 dB SNR
+    -10,   // SF8 needs at least -10 dB SNR
+    -12.5, // SF9 needs at least -12.5 dB SNR
+    -15,  // SF10 needs at least -15 dB SNR
+    -17.5,// SF11 needs at least -17.5 dB SNR
+    -20   // SF12 needs at least -20 dB SNR
+};
+
+float SNRPacketScorer::getSNRFloor(uint8_t sf) {
+  if (sf < 5) sf = 5;
+  if (sf > 12) sf = 12;
+  return snr_threshold[sf - 5];
+}
+
+void SNRPacketScorer::setRadioParams(uint8_t sf, float bw_khz) {
+  _snr_floor = getSNRFloor(sf);
+}
+
+float SNRPacketScorer::score(float snr, int packet_len) const {
+  if (snr < _snr_floor) return 0.0f;    // Below threshold, no chance of success
+
+  float success_rate_based_on_snr = (snr - _snr_floor) / 10.0f;
+  float collision_penalty = 1.0f - (packet_len / 256.0f);   // Assuming max packet of 256 bytes
+
+  float s = success_rate_based_on_snr * collision_penalty;
+  if (s < 0.0f) return 0.0f;
+  return s > 1.0f ? 1.0f : s;
+}
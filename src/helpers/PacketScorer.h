@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * \brief  Strategy for scoring received packets (0.0 = worst .. 1.0 = best), which drives the flood RX delay.
+ *         Radio drivers call setRadioParams() whenever SF or BW are changed, so implementations can
+ *         precompute anything that depends on them.
+ */
+class PacketScorer {
+public:
+  virtual void setRadioParams(uint8_t sf, float bw_khz) { }
+  virtual float score(float snr, int packet_len) const = 0;
+};
+
+/**
+ * \brief  Default scorer: SNR margin above the demodulation floor of the actual SF, with a penalty
+ *         for longer packets (more exposed to collisions).
+ *         NOTE: the floor is per SF only, as the reported SNR is already relative to the channel bandwidth.
+ */
+class SNRPacketScorer : public PacketScorer {
+  float _snr_floor;   // zero score below this SNR
+
+public:
+  SNRPacketScorer() { setRadioParams(10, 250.0f); }
+
+  void setRadioParams(uint8_t sf, float bw_khz) override;
+  float score(float snr, int packet_len) const override;
+
+  /**
+   * \returns  approx minimum SNR (dB) for successful reception at given SF
+   */
+  static float getSNRFloor(uint8_t sf);
+};
@@ -121,20 +121,22 @@ RegionEntry* RegionMap::putRegion(const char* name, uint16_t parent_id, uint16_t
 }
 
 RegionEntry* RegionMap::findMatch(mesh::Packet* packet, uint8_t mask) {
+  uint16_t code = packet->transport_codes[0];
+  if (code == 0 || code == 0xFFFF) return NULL;   // reserved, can never match
+
   for (int i = 0; i < num_regions; i++) {
     auto region = &regions[i];
     if ((region->flags & mask) == 0) {   // does region allow this? (per 'mask' param)
-      TransportKey keys[4];
+      const PrecomputedTransportKey* keys[4];
       int num;
       if (region->name[0] == '#') {   // auto hashtag region
-        _store->getAutoKeyFor(region->id, region->name, keys[0]);
+        keys[0] = _store->getAutoMatcherFor(region->id, region->name);
         num = 1;
       } else {
-        num = _store->loadKeysFor(region->id, keys, 4);
+        num = _store->loadMatchersFor(region->id, keys, 4);
       }
       for (int j = 0; j < num; j++) {
-        uint16_t code = keys[j].calcTransportCode(packet);
-        if (packet->transport_codes[0] == code) {   // a match!!
+        if (keys[j]->calcTransportCode(packet) == code) {   // a match!!
           return region;
         }
       }
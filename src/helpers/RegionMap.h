@@ -8,6 +8,10 @@
   #define MAX_REGION_ENTRIES  32
 #endif
 
+#if MAX_TKS_ENTRIES < MAX_REGION_ENTRIES
+  #error "MAX_TKS_ENTRIES must be at least MAX_REGION_ENTRIES"
+#endif
+
 #define REGION_DENY_FLOOD   0x01
 #define REGION_DENY_DIRECT  0x02   // reserved for future
 
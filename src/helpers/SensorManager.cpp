@@ -0,0 +1,71 @@
+#include "SensorManager.h"
+#include <Arduino.h>
+
+int SensorManager::addSchedule(uint32_t period_millis, uint16_t cost_millis, bool active) {
+  if (num_scheduled >= MAX_SCHEDULED_SENSORS) return -1;
+
+  auto s = &schedule[num_scheduled];
+  s->period_millis = period_millis;
+  s->cost_millis = cost_millis;
+  s->due = millis();   // sample asap
+  s->active = active;
+  return num_scheduled++;
+}
+
+void SensorManager::setScheduleActive(int id, bool active) {
+  if (id < 0 || id >= num_scheduled) return;
+
+  auto s = &schedule[id];
+  if (active && !s->active) s->due = millis() + s->period_millis;
+  s->active = active;
+}
+
+void SensorManager::setSchedulePeriod(int id, uint32_t period_millis) {
+  if (id < 0 || id >= num_scheduled) return;
+
+  auto s = &schedule[id];
+  s->due -= s->period_millis;
+  s->due += period_millis;   // keep same last sample time
+  s->period_millis = period_millis;
+}
+
+unsigned long SensorManager::getNextDeadline() const {
+  unsigned long next = 0;
+  bool found = false;
+  for (int i = 0; i < num_scheduled; i++) {
+    if (!schedule[i].active) continue;
+    if (!found || (long)(schedule[i].due - next) < 0) next = schedule[i].due;
+    found = true;
+  }
+  return next;
+}
+
+bool SensorManager::runSchedule() {
+  unsigned long now = millis();
+  unsigned long next = getNextDeadline();
+  if (next == 0 || (long)(next - now) > 0) return false;   // nothing due yet
+
+  bool fresh = false;
+  uint32_t cost = 0;
+  for (int i = 0; i < num_scheduled; i++) {   // first, all that are due
+    auto s = &schedule[i];
+    if (s->active && (long)(s->due - now) <= 0) {
+      if (sampleSensor(i)) fresh = true;
+      cost += s->cost_millis;
+      s->due = now + s->period_millis;
+    }
+  }
+  for (int i = 0; i < num_scheduled; i++) {   // then, any due soon, while bus is awake anyway
+    auto s = &schedule[i];
+    uint32_t ahead = s->period_millis / 4;
+    if (ahead > SENSOR_WAKE_AHEAD_MILLIS) ahead = SENSOR_WAKE_AHEAD_MILLIS;
+    if (s->active && (long)(s->due - now) <= (long)ahead && cost + s->cost_millis <= SENSOR_WAKE_MAX_COST_MILLIS) {
+      if (sampleSensor(i)) fresh = true;
+      cost += s->cost_millis;
+      s->due = now + s->period_millis;
+    }
+  }
+
+  if (fresh) sample_seq++;
+  return fresh;
+}
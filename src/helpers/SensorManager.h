@@ -9,12 +9,60 @@
 
 #define TELEM_CHANNEL_SELF   1   // LPP data channel for 'self' device
 
+#ifndef MAX_SCHEDULED_SENSORS
+  #define MAX_SCHEDULED_SENSORS        16
+#endif
+#ifndef SENSOR_WAKE_AHEAD_MILLIS
+  #define SENSOR_WAKE_AHEAD_MILLIS     5000   // sensors due this soon are sampled early, in same wake window
+#endif
+#ifndef SENSOR_WAKE_MAX_COST_MILLIS
+  #define SENSOR_WAKE_MAX_COST_MILLIS   100   // max bus time spent on early samples, per wake window
+#endif
+
 class SensorManager {
+  struct SampleSchedule {
+    uint32_t period_millis;
+    uint16_t cost_millis;     // estimated bus time of one sample
+    unsigned long due;
+    bool active;              // false = paused (not sampled, not a deadline)
+  };
+  SampleSchedule schedule[MAX_SCHEDULED_SENSORS];
+  int num_scheduled;
+  uint32_t sample_seq;
+
+protected:
+  /**
+   * \brief  register a sensor to be sampled every 'period_millis'. sampleSensor() is called with returned id.
+   * \param  active  false to register it paused (see setScheduleActive())
+   * \returns  schedule id, or -1 if no room
+   */
+  int addSchedule(uint32_t period_millis, uint16_t cost_millis, bool active=true);
+  void setSchedulePeriod(int id, uint32_t period_millis);
+
+  /**
+   * \brief  pause/resume sampling of 'id'. When resumed, next sample is one period from now (caller has fresh readings)
+   */
+  void setScheduleActive(int id, bool active);
+  void clearSchedule() { num_scheduled = 0; }
+
+  /**
+   * \brief  sample the sensor registered as 'id'
+   * \returns  true if there are new readings (ie. for alert triggers to check)
+   */
+  virtual bool sampleSensor(int id) { return false; }
+
+  /**
+   * \brief  when any sensor is due, opens a wake window: samples all due sensors, plus those due soon (within cost budget)
+   *          so the bus is woken once for the batch. (call from loop())
+   * \returns  true if any new readings
+   */
+  bool runSchedule();
+
 public:
   double node_lat, node_lon;  // modify these, if you want to affect Advert location
   double node_altitude;       // altitude in meters
 
-  SensorManager() { node_lat = 0; node_lon = 0; node_altitude = 0; }
+  SensorManager() { node_lat = 0; node_lon = 0; node_altitude = 0; num_scheduled = 0; sample_seq = 0; }
   virtual bool begin() { return false; }
   virtual bool querySensors(uint8_t requester_permissions, CayenneLPP& telemetry) { return false; }
   virtual void loop() { }
@@ -24,6 +72,16 @@ public:
   virtual bool setSettingValue(const char* name, const char* value) { return false; }
   virtual LocationProvider* getLocationProvider() { return NULL; }
 
+  /**
+   * \returns  millis() when next sample is due (so main loop can sleep until then), or zero if none scheduled (or all paused)
+   */
+  unsigned long getNextDeadline() const;
+
+  /**
+   * \returns  counter that changes whenever sensors have new readings
+   */
+  uint32_t getSampleSeq() const { return sample_seq; }
+
   // Helper functions to manage setting by keys (useful in many places ...)
   const char* getSettingByKey(const char* key) {
     int num = getNumSettings();
@@ -8,20 +8,22 @@ PacketQueue::PacketQueue(int max_entries) {
   _num = 0;
 }
 
-int PacketQueue::countBefore(uint32_t now) const {
+int PacketQueue::countBefore(uint32_t now, uint8_t radio_idx) const {
   int n = 0;
   for (int j = 0; j < _num; j++) {
     if (_schedule_table[j] > now) continue;   // scheduled for future... ignore for now
+    if (radio_idx != 0xFF && _table[j]->_radio_idx != radio_idx) continue;
     n++;
   }
   return n;
 }
 
-mesh::Packet* PacketQueue::get(uint32_t now) {
+mesh::Packet* PacketQueue::get(uint32_t now, uint8_t radio_idx) {
   uint8_t min_pri = 0xFF;
   int best_idx = -1;
   for (int j = 0; j < _num; j++) {
     if (_schedule_table[j] > now) continue;   // scheduled for future... ignore for now
+    if (radio_idx != 0xFF && _table[j]->_radio_idx != radio_idx) continue;
     if (_pri_table[j] < min_pri) {  // select most important priority amongst non-future entries
       min_pri = _pri_table[j];
       best_idx = j;
@@ -90,10 +92,18 @@ mesh::Packet* StaticPoolPacketManager::getNextOutbound(uint32_t now) {
   return send_queue.get(now);
 }
 
+mesh::Packet* StaticPoolPacketManager::getNextOutboundFor(uint8_t radio_idx, uint32_t now) {
+  return send_queue.get(now, radio_idx);
+}
+
 int  StaticPoolPacketManager::getOutboundCount(uint32_t now) const {
   return send_queue.countBefore(now);
 }
 
+int StaticPoolPacketManager::getOutboundCountFor(uint8_t radio_idx, uint32_t now) const {
+  return send_queue.countBefore(now, radio_idx);
+}
+
 int StaticPoolPacketManager::getFreeCount() const {
   return unused.count();
 }
@@ -1,6 +1,15 @@
 #include "TransportKeyStore.h"
 #include <SHA256.h>
 
+static uint16_t reserveCodes(uint16_t code) {
+  if (code == 0) {     // reserve codes 0000 and FFFF
+    code++;
+  } else if (code == 0xFFFF) {
+    code--;
+  }
+  return code;
+}
+
 uint16_t TransportKey::calcTransportCode(const mesh::Packet* packet) const {
   uint16_t code;
   SHA256 sha;
@@ -9,12 +18,103 @@ uint16_t TransportKey::calcTransportCode(const mesh::Packet* packet) const {
   sha.update(&type, 1);
   sha.update(packet->payload, packet->payload_len);
   sha.finalizeHMAC(key, sizeof(key), &code, 2);
-  if (code == 0) {     // reserve codes 0000 and FFFF
-    code++;
-  } else if (code == 0xFFFF) {
-    code--;
+  return reserveCodes(code);
+}
+
+#define HMAC_BLOCK_SIZE   64
+
+// NOTE: the SHA256 class doesn't expose its chaining state, so the midstates are resumed with this plain SHA-256 block function
+static const uint32_t sha256_k[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+static const uint32_t sha256_iv[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+#define ROTR32(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256Block(uint32_t h[8], const uint8_t block[HMAC_BLOCK_SIZE]) {
+  uint32_t w[16];
+  for (int i = 0; i < 16; i++) {
+    w[i] = ((uint32_t)block[i*4] << 24) | ((uint32_t)block[i*4 + 1] << 16) | ((uint32_t)block[i*4 + 2] << 8) | block[i*4 + 3];
   }
-  return code;
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+  for (int i = 0; i < 64; i++) {
+    if (i >= 16) {   // message schedule, in a 16 word ring
+      uint32_t w15 = w[(i - 15) & 15], w2 = w[(i - 2) & 15];
+      w[i & 15] += (ROTR32(w15, 7) ^ ROTR32(w15, 18) ^ (w15 >> 3)) + w[(i - 7) & 15] + (ROTR32(w2, 17) ^ ROTR32(w2, 19) ^ (w2 >> 10));
+    }
+    uint32_t t1 = hh + (ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i & 15];
+    uint32_t t2 = (ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    hh = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+  }
+  h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+}
+
+// hash 'data' (of 'len' bytes), following one already hashed block (the HMAC key block), from given midstate
+static void sha256Resume(const uint32_t mid[8], const uint8_t* data, int len, uint8_t digest[32]) {
+  uint32_t h[8];
+  memcpy(h, mid, sizeof(h));
+
+  uint8_t block[HMAC_BLOCK_SIZE];
+  int n = 0;
+  while (len - n >= HMAC_BLOCK_SIZE) {
+    sha256Block(h, &data[n]);
+    n += HMAC_BLOCK_SIZE;
+  }
+  int rem = len - n;
+  memcpy(block, &data[n], rem);
+  block[rem++] = 0x80;
+  if (rem > HMAC_BLOCK_SIZE - 8) {   // no room for length, needs another block
+    memset(&block[rem], 0, HMAC_BLOCK_SIZE - rem);
+    sha256Block(h, block);
+    rem = 0;
+  }
+  memset(&block[rem], 0, HMAC_BLOCK_SIZE - 8 - rem);
+  uint64_t bits = ((uint64_t)HMAC_BLOCK_SIZE + len) * 8;
+  for (int i = 0; i < 8; i++) block[HMAC_BLOCK_SIZE - 1 - i] = (uint8_t)(bits >> (i * 8));
+  sha256Block(h, block);
+
+  for (int i = 0; i < 8; i++) {   // big-endian
+    digest[i*4] = h[i] >> 24; digest[i*4 + 1] = h[i] >> 16; digest[i*4 + 2] = h[i] >> 8; digest[i*4 + 3] = h[i];
+  }
+}
+
+void PrecomputedTransportKey::init(const TransportKey& key) {
+  uint8_t block[HMAC_BLOCK_SIZE];
+
+  memset(block, 0x36, sizeof(block));  // ipad
+  for (int i = 0; i < sizeof(key.key); i++) block[i] ^= key.key[i];
+  memcpy(inner, sha256_iv, sizeof(inner));
+  sha256Block(inner, block);
+
+  memset(block, 0x5C, sizeof(block));  // opad
+  for (int i = 0; i < sizeof(key.key); i++) block[i] ^= key.key[i];
+  memcpy(outer, sha256_iv, sizeof(outer));
+  sha256Block(outer, block);
+
+  memset(block, 0, sizeof(block));
+}
+
+uint16_t PrecomputedTransportKey::calcTransportCode(const mesh::Packet* packet) const {
+  uint8_t msg[1 + MAX_PACKET_PAYLOAD];
+  msg[0] = packet->getPayloadType();
+  memcpy(&msg[1], packet->payload, packet->payload_len);
+
+  uint8_t digest[32];
+  sha256Resume(inner, msg, 1 + packet->payload_len, digest);
+  sha256Resume(outer, digest, sizeof(digest), digest);
+
+  uint16_t code;
+  memcpy(&code, digest, 2);
+  return reserveCodes(code);
 }
 
 bool TransportKey::isNull() const {
@@ -24,22 +124,36 @@ bool TransportKey::isNull() const {
   return true;  // key is all zeroes
 }
 
-void TransportKeyStore::putCache(uint16_t id, const TransportKey& key) {
+int TransportKeyStore::putCache(uint16_t id, const TransportKey& key) {
+  int i;
   if (num_cache < MAX_TKS_ENTRIES) {
-    cache_ids[num_cache] = id;
-    cache_keys[num_cache] = key;
-    num_cache++;
-  } else {
-    // TODO: evict oldest cache entry
+    i = num_cache++;
+  } else {   // evict least recently used
+    i = 0;
+    for (int j = 1; j < num_cache; j++) {
+      if (cache_last_used[j] < cache_last_used[i]) i = j;
+    }
+  }
+  cache_ids[i] = id;
+  cache_keys[i] = key;
+  cache_hmacs[i].init(key);
+  cache_last_used[i] = ++use_counter;
+  return i;
+}
+
+int TransportKeyStore::findCache(uint16_t id) const {
+  for (int i = 0; i < num_cache; i++) {
+    if (cache_ids[i] == id) return i;
   }
+  return -1;  // not found
 }
 
 void TransportKeyStore::getAutoKeyFor(uint16_t id, const char* name, TransportKey& dest) {
-  for (int i = 0; i < num_cache; i++) {  // first, check cache
-    if (cache_ids[i] == id) {   // cache hit!
-      dest = cache_keys[i];
-      return;
-    }
+  int i = findCache(id);  // first, check cache
+  if (i >= 0) {   // cache hit!
+    cache_last_used[i] = ++use_counter;
+    dest = cache_keys[i];
+    return;
   }
   // calc key for publicly-known hashtag region name
   SHA256 sha;
@@ -49,10 +163,23 @@ void TransportKeyStore::getAutoKeyFor(uint16_t id, const char* name, TransportKe
   putCache(id, dest);
 }
 
+const PrecomputedTransportKey* TransportKeyStore::getAutoMatcherFor(uint16_t id, const char* name) {
+  int i = findCache(id);
+  if (i < 0) {
+    TransportKey key;
+    getAutoKeyFor(id, name, key);   // adds to cache
+    i = findCache(id);
+  } else {
+    cache_last_used[i] = ++use_counter;
+  }
+  return &cache_hmacs[i];
+}
+
 int TransportKeyStore::loadKeysFor(uint16_t id, TransportKey keys[], int max_num) {
   int n = 0;
   for (int i = 0; i < num_cache && n < max_num; i++) {  // first, check cache
     if (cache_ids[i] == id) {
+      cache_last_used[i] = ++use_counter;
       keys[n++] = cache_keys[i];
     }
   }
@@ -60,13 +187,28 @@ int TransportKeyStore::loadKeysFor(uint16_t id, TransportKey keys[], int max_num
 
   // TODO:  retrieve from difficult-to-copy keystore
 
-  // store in cache (if room)
+  // store in cache
   for (int i = 0; i < n; i++) {
     putCache(id, keys[i]);
   }
   return n;
 }
 
+int TransportKeyStore::loadMatchersFor(uint16_t id, const PrecomputedTransportKey* dest[], int max_num) {
+  if (findCache(id) < 0) {
+    TransportKey keys[4];
+    loadKeysFor(id, keys, max_num < 4 ? max_num : 4);   // adds to cache
+  }
+  int n = 0;
+  for (int i = 0; i < num_cache && n < max_num; i++) {
+    if (cache_ids[i] == id) {
+      cache_last_used[i] = ++use_counter;
+      dest[n++] = &cache_hmacs[i];
+    }
+  }
+  return n;
+}
+
 bool TransportKeyStore::saveKeysFor(uint16_t id, const TransportKey keys[], int num) {
   invalidateCache();
 
@@ -11,20 +11,51 @@ struct TransportKey {
   bool isNull() const;
 };
 
-#define MAX_TKS_ENTRIES   16
+/**
+ * \brief  A TransportKey with its HMAC inner/outer midstates pre-computed (ie. SHA256 chaining state after the ipad/opad
+ *         key blocks), so that each calcTransportCode() skips hashing those two blocks. Only the 32-byte chaining states
+ *         are kept (not whole SHA256 objects), so ~64 bytes per key.
+ */
+struct PrecomputedTransportKey {
+  uint32_t inner[8], outer[8];
+
+  void init(const TransportKey& key);
+  uint16_t calcTransportCode(const mesh::Packet* packet) const;   // same result as TransportKey::calcTransportCode()
+};
+
+// NOTE: RegionMap::findMatch() cycles through every region's key, so the cache must hold them all, or LRU misses every time
+#ifndef MAX_TKS_ENTRIES
+  #ifdef MAX_REGION_ENTRIES
+    #define MAX_TKS_ENTRIES   MAX_REGION_ENTRIES    // ~86 bytes per entry
+  #else
+    #define MAX_TKS_ENTRIES   32
+  #endif
+#endif
 
 class TransportKeyStore {
   uint16_t     cache_ids[MAX_TKS_ENTRIES];
   TransportKey cache_keys[MAX_TKS_ENTRIES];
+  PrecomputedTransportKey cache_hmacs[MAX_TKS_ENTRIES];
+  uint32_t     cache_last_used[MAX_TKS_ENTRIES];
+  uint32_t use_counter;
   int num_cache;
 
-  void putCache(uint16_t id, const TransportKey& key);
+  int putCache(uint16_t id, const TransportKey& key);
   void invalidateCache() { num_cache = 0; }
+  int findCache(uint16_t id) const;
 
 public:
-  TransportKeyStore() { num_cache = 0; }
+  TransportKeyStore() { num_cache = 0; use_counter = 0; }
   void getAutoKeyFor(uint16_t id, const char* name, TransportKey& dest);
   int loadKeysFor(uint16_t id, TransportKey keys[], int max_num);
+
+  /**
+   * \brief  same as getAutoKeyFor()/loadKeysFor(), but returns the pre-computed forms, for fast packet matching.
+   *         NOTE: returned pointers are into the cache, and are only valid until the next call.
+   */
+  const PrecomputedTransportKey* getAutoMatcherFor(uint16_t id, const char* name);
+  int loadMatchersFor(uint16_t id, const PrecomputedTransportKey* dest[], int max_num);
+
   bool saveKeysFor(uint16_t id, const TransportKey keys[], int num);
   bool removeKeys(uint16_t id);
   bool clear();
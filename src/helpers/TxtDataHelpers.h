@@ -6,6 +6,9 @@
 #define TXT_TYPE_PLAIN          0    // a plain text message
 #define TXT_TYPE_CLI_DATA       1    // a CLI command
 #define TXT_TYPE_SIGNED_PLAIN   2    // plain text, signed by sender
+#define TXT_TYPE_MULTI_POST     3    // several signed plain texts: { [4 timestamp][4 signer prefix][1 text_len][text] } ...
+
+#define LOGIN_CAP_MULTI_POST    0x01 // (room login caps byte) client accepts TXT_TYPE_MULTI_POST pushes
 
 class StrHelper {
 public:
@@ -96,6 +96,15 @@ protected:
    */
   static uint16_t fletcher16(const uint8_t *data, size_t len);
 
+  /**
+   * @brief Calculate CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), table driven
+   *
+   * @param data Pointer to data to calculate CRC for
+   * @param len Length of data in bytes
+   * @return Calculated CRC-16
+   */
+  static uint16_t crc16(const uint8_t *data, size_t len);
+
   /**
    * @brief Validate received checksum against calculated checksum
    *
@@ -0,0 +1,374 @@
+#include "IPBridge.h"
+
+#include <SHA256.h>
+
+#ifdef WITH_IP_BRIDGE
+
+#if !defined(WIFI_SSID) || !defined(WIFI_PWD)
+#error "WIFI_SSID and WIFI_PWD must be defined"
+#endif
+
+IPBridge::IPBridge(NodePrefs *prefs, mesh::PacketManager *mgr, mesh::RTCClock *rtc)
+    : BridgeBase(prefs, mgr, rtc), _num_peers(0), _net_up(false), _tx_len(0), _tx_counter(0), _next_recent(0)
+#ifdef WITH_IP_BRIDGE_TCP
+    , _server(IP_BRIDGE_PORT)
+#endif
+{
+  for (int i = 0; i < IP_BRIDGE_MAX_PEERS; i++) {
+    _peers[i].configured = false;
+  }
+  memset(_recent_tags, 0, sizeof(_recent_tags));
+
+#ifdef WITH_IP_BRIDGE_PEERS
+  // parse the comma separated list of peer addresses
+  char list[] = WITH_IP_BRIDGE_PEERS;
+  char *sp = list;
+  while (*sp && _num_peers < IP_BRIDGE_MAX_PEERS) {
+    char *ep = sp;
+    while (*ep && *ep != ',') ep++;
+    bool last = *ep == 0;
+    *ep = 0;
+
+    if (_peers[_num_peers].addr.fromString(sp)) {
+      _peers[_num_peers++].configured = true;
+    } else {
+      BRIDGE_DEBUG_PRINTLN("Invalid peer address: %s\n", sp);
+    }
+    if (last) break;
+    sp = ep + 1;
+  }
+#endif
+#ifndef WITH_IP_BRIDGE_TCP
+  _mcast_group.fromString(IP_BRIDGE_MCAST_GROUP);
+#endif
+}
+
+void IPBridge::begin() {
+  BRIDGE_DEBUG_PRINTLN("Initializing, port %d...\n", IP_BRIDGE_PORT);
+  if (strcmp(_prefs->bridge_secret, IP_BRIDGE_DEFAULT_SECRET) == 0) {
+    BRIDGE_DEBUG_PRINTLN("WARNING: bridge.secret is the default, batches will NOT be authenticated\n");
+  }
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(WIFI_SSID, WIFI_PWD);   // (connects in background)
+
+  _net_up = false;
+  _tx_len = 0;
+
+  // Update bridge state
+  _initialized = true;
+}
+
+void IPBridge::end() {
+  BRIDGE_DEBUG_PRINTLN("Stopping...\n");
+  stopNetwork();
+
+  // Turn off WiFi
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+
+  // Update bridge state
+  _initialized = false;
+}
+
+void IPBridge::startNetwork() {
+  BRIDGE_DEBUG_PRINTLN("WiFi connected, IP: %s\n", WiFi.localIP().toString().c_str());
+#ifdef WITH_IP_BRIDGE_TCP
+  _server.begin();
+  for (int i = 0; i < IP_BRIDGE_MAX_PEERS; i++) {
+    _peers[i].rx_len = 0;
+    _peers[i].next_connect = millis();
+  }
+#else
+  _udp.beginMulticast(_mcast_group, IP_BRIDGE_PORT);
+#endif
+  _net_up = true;
+}
+
+void IPBridge::stopNetwork() {
+  if (!_net_up) return;
+
+#ifdef WITH_IP_BRIDGE_TCP
+  for (int i = 0; i < IP_BRIDGE_MAX_PEERS; i++) {
+    _peers[i].client.stop();
+  }
+  _server.end();
+#else
+  _udp.stop();
+#endif
+  _net_up = false;
+  _tx_len = 0;
+}
+
+bool IPBridge::hasSecret() const {
+  return _prefs->bridge_secret[0] != 0 && strcmp(_prefs->bridge_secret, IP_BRIDGE_DEFAULT_SECRET) != 0;
+}
+
+void IPBridge::calcAuthTag(const uint8_t *data, size_t len, uint8_t *tag) {
+  size_t key_len = strnlen(_prefs->bridge_secret, sizeof(_prefs->bridge_secret));
+  SHA256 sha;
+  sha.resetHMAC(_prefs->bridge_secret, key_len);
+  sha.update(data, len);
+  sha.finalizeHMAC(_prefs->bridge_secret, key_len, tag, IP_BRIDGE_HMAC_SIZE);
+}
+
+bool IPBridge::isReplay(const uint8_t *data, const uint8_t *tag) {
+  uint32_t timestamp;
+  memcpy(&timestamp, &data[BATCH_HEADER_SIZE], 4);
+  uint32_t now = _rtc->getCurrentTime();
+  uint32_t diff = timestamp > now ? timestamp - now : now - timestamp;
+  if (diff > IP_BRIDGE_REPLAY_WINDOW_SECS) {
+    BRIDGE_DEBUG_PRINTLN("RX batch timestamp out of window, diff=%d secs (check clocks)\n", diff);
+    return true;
+  }
+
+  // within window, so reject if seen recently
+  for (int i = 0; i < IP_BRIDGE_REPLAY_CACHE_SIZE; i++) {
+    if (memcmp(_recent_tags[i], tag, IP_BRIDGE_HMAC_SIZE) == 0) {
+      BRIDGE_DEBUG_PRINTLN("RX replayed batch\n");
+      return true;
+    }
+  }
+  memcpy(_recent_tags[_next_recent], tag, IP_BRIDGE_HMAC_SIZE);
+  _next_recent = (_next_recent + 1) % IP_BRIDGE_REPLAY_CACHE_SIZE;
+  return false;
+}
+
+#ifdef WITH_IP_BRIDGE_TCP
+void IPBridge::checkTcpPeers() {
+  // accept new incoming connection, into a free (non-configured) slot
+  WiFiClient incoming = _server.available();
+  if (incoming) {
+    int i = _num_peers;
+    while (i < IP_BRIDGE_MAX_PEERS && _peers[i].client.connected()) i++;
+    if (i < IP_BRIDGE_MAX_PEERS) {
+      BRIDGE_DEBUG_PRINTLN("TCP accepted %s\n", incoming.remoteIP().toString().c_str());
+      _peers[i].client = incoming;
+      _peers[i].addr = incoming.remoteIP();
+      _peers[i].rx_len = 0;
+    } else {
+      incoming.stop();   // no free slots
+    }
+  }
+
+  bool attempted = false;   // only one (blocking) connect attempt per loop()
+  for (int i = 0; i < IP_BRIDGE_MAX_PEERS; i++) {
+    Peer &p = _peers[i];
+    if (!p.client.connected()) {
+      if (p.configured && !attempted && (long)(millis() - p.next_connect) >= 0) {
+        attempted = true;
+        p.next_connect = millis() + IP_BRIDGE_RECONNECT_MILLIS;
+        p.rx_len = 0;
+        if (p.client.connect(p.addr, IP_BRIDGE_PORT, IP_BRIDGE_CONNECT_TIMEOUT_MILLIS)) {
+          BRIDGE_DEBUG_PRINTLN("TCP connected to %s\n", p.addr.toString().c_str());
+        }
+      }
+      continue;
+    }
+
+    // read as much as is available, then extract each complete [length][batch]
+    int avail = p.client.available();
+    if (avail > 0) {
+      int n = sizeof(p.rx_buffer) - p.rx_len;
+      if (avail < n) n = avail;
+      n = p.client.read(&p.rx_buffer[p.rx_len], n);
+      if (n > 0) p.rx_len += n;
+    }
+    while (p.rx_len >= 2) {
+      uint16_t len = (p.rx_buffer[0] << 8) | p.rx_buffer[1];
+      if (len > IP_BRIDGE_BATCH_SIZE) {
+        BRIDGE_DEBUG_PRINTLN("TCP invalid batch length %d, dropping connection\n", len);
+        p.client.stop();
+        p.rx_len = 0;
+        break;
+      }
+      if (p.rx_len < 2 + len) break;   // incomplete
+
+      recvBatch(&p.rx_buffer[2], len);
+      p.rx_len -= 2 + len;
+      memmove(p.rx_buffer, &p.rx_buffer[2 + len], p.rx_len);
+    }
+  }
+}
+#endif
+
+void IPBridge::loop() {
+  // Guard against uninitialized state
+  if (_initialized == false) {
+    return;
+  }
+
+  if (WiFi.status() != WL_CONNECTED) {
+    stopNetwork();
+    return;
+  }
+  if (!_net_up) {
+    startNetwork();
+  }
+
+#ifdef WITH_IP_BRIDGE_TCP
+  checkTcpPeers();
+#else
+  int len;
+  while ((len = _udp.parsePacket()) > 0) {
+    uint8_t buffer[IP_BRIDGE_BATCH_SIZE];
+    if (len > sizeof(buffer)) {
+      BRIDGE_DEBUG_PRINTLN("RX datagram too large, len=%d\n", len);
+      _udp.flush();
+      continue;
+    }
+    len = _udp.read(buffer, len);
+    if (len > 0) recvBatch(buffer, len);
+  }
+#endif
+
+  flushTx();
+}
+
+void IPBridge::recvBatch(const uint8_t *data, uint16_t len) {
+  if (len < BATCH_HEADER_SIZE + BRIDGE_CHECKSUM_SIZE) {
+    BRIDGE_DEBUG_PRINTLN("RX batch too small, len=%d\n", len);
+    return;
+  }
+
+  // Check batch header
+  uint16_t received_magic = (data[0] << 8) | data[1];
+  if (received_magic != BRIDGE_PACKET_MAGIC || data[2] != PROTOCOL_VERSION) {
+    BRIDGE_DEBUG_PRINTLN("RX invalid magic 0x%04X, or version\n", received_magic);
+    return;
+  }
+  bool is_hmac = (data[3] & IP_BRIDGE_FLAG_HMAC) != 0;
+  if (is_hmac != hasSecret()) {
+    BRIDGE_DEBUG_PRINTLN("RX authentication mismatch\n");   // (either side has no secret)
+    return;
+  }
+
+  // Validate HMAC, or checksum
+  uint16_t header_size = getHeaderSize();
+  uint16_t tag_size = getTagSize();
+  if (len < header_size + tag_size) return;
+  len -= tag_size;
+  if (is_hmac) {
+    uint8_t tag[IP_BRIDGE_HMAC_SIZE];
+    calcAuthTag(data, len, tag);
+    if (memcmp(tag, &data[len], IP_BRIDGE_HMAC_SIZE) != 0) {
+      BRIDGE_DEBUG_PRINTLN("RX HMAC mismatch\n");
+      return;
+    }
+    if (isReplay(data, tag)) return;
+  } else {
+    uint16_t received_checksum = (data[len] << 8) | data[len + 1];
+    if (!validateChecksum(data, len, received_checksum)) {
+      BRIDGE_DEBUG_PRINTLN("RX checksum mismatch, rcv=0x%04X\n", received_checksum);
+      return;
+    }
+  }
+
+  // extract each packet
+  uint16_t i = header_size;
+  while (i < len) {
+    uint8_t pkt_len = data[i++];
+    if (i + pkt_len > len) {
+      BRIDGE_DEBUG_PRINTLN("RX truncated packet in batch\n");
+      break;
+    }
+    BRIDGE_DEBUG_PRINTLN("RX, payload_len=%d\n", (uint32_t)pkt_len);
+
+    mesh::Packet *pkt = _mgr->allocNew();
+    if (!pkt) {
+      BRIDGE_DEBUG_PRINTLN("RX failed to allocate packet\n");
+      break;
+    }
+    if (pkt->readFrom(&data[i], pkt_len)) {
+      onPacketReceived(pkt);
+    } else {
+      _mgr->free(pkt);
+    }
+    i += pkt_len;
+  }
+}
+
+void IPBridge::sendBatch(const uint8_t *data, uint16_t len) {
+#ifdef WITH_IP_BRIDGE_TCP
+  uint8_t len_prefix[2];
+  len_prefix[0] = (len >> 8) & 0xFF;
+  len_prefix[1] = len & 0xFF;
+  for (int i = 0; i < IP_BRIDGE_MAX_PEERS; i++) {
+    if (_peers[i].client.connected()) {
+      _peers[i].client.write(len_prefix, 2);
+      _peers[i].client.write(data, len);
+    }
+  }
+#else
+  _udp.beginPacket(_mcast_group, IP_BRIDGE_PORT);
+  _udp.write(data, len);
+  _udp.endPacket();
+
+  for (int i = 0; i < _num_peers; i++) {
+    _udp.beginPacket(_peers[i].addr, IP_BRIDGE_PORT);
+    _udp.write(data, len);
+    _udp.endPacket();
+  }
+#endif
+}
+
+void IPBridge::flushTx() {
+  if (_tx_len <= getHeaderSize()) return;   // no packets in batch
+
+  if (hasSecret()) {
+    calcAuthTag(_tx_batch, _tx_len, &_tx_batch[_tx_len]);
+  } else {
+    uint16_t checksum = fletcher16(_tx_batch, _tx_len);
+    _tx_batch[_tx_len] = (checksum >> 8) & 0xFF;
+    _tx_batch[_tx_len + 1] = checksum & 0xFF;
+  }
+  sendBatch(_tx_batch, _tx_len + getTagSize());
+  BRIDGE_DEBUG_PRINTLN("TX batch, len=%d\n", _tx_len);
+  _tx_len = 0;
+}
+
+void IPBridge::sendPacket(mesh::Packet *packet) {
+  // Guard against uninitialized state
+  if (_initialized == false || !_net_up) {
+    return;
+  }
+
+  // First validate the packet pointer
+  if (!packet) {
+    BRIDGE_DEBUG_PRINTLN("TX invalid packet pointer\n");
+    return;
+  }
+
+  if (!_seen_packets.hasSeen(packet)) {
+    uint8_t buffer[MAX_TRANS_UNIT + 1];
+    uint8_t len = packet->writeTo(buffer);
+
+    if (_tx_len + 1 + len + IP_BRIDGE_HMAC_SIZE > sizeof(_tx_batch)) {
+      flushTx();   // batch full, send now
+    }
+    if (_tx_len == 0) {   // start new batch
+      _tx_batch[0] = (BRIDGE_PACKET_MAGIC >> 8) & 0xFF;
+      _tx_batch[1] = BRIDGE_PACKET_MAGIC & 0xFF;
+      _tx_batch[2] = PROTOCOL_VERSION;
+      if (hasSecret()) {
+        _tx_batch[3] = IP_BRIDGE_FLAG_HMAC;
+        uint32_t timestamp = _rtc->getCurrentTime();
+        memcpy(&_tx_batch[BATCH_HEADER_SIZE], &timestamp, 4);
+        _tx_counter++;
+        memcpy(&_tx_batch[BATCH_HEADER_SIZE + 4], &_tx_counter, 4);
+      } else {
+        _tx_batch[3] = 0;
+      }
+      _tx_len = getHeaderSize();
+    }
+    _tx_batch[_tx_len++] = len;
+    memcpy(&_tx_batch[_tx_len], buffer, len);
+    _tx_len += len;
+  }
+}
+
+void IPBridge::onPacketReceived(mesh::Packet *packet) {
+  handleReceivedPacket(packet);
+}
+
+#endif
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "MeshCore.h"
+#include "helpers/bridges/BridgeBase.h"
+
+#ifdef WITH_IP_BRIDGE
+
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+#ifndef IP_BRIDGE_PORT
+  #define IP_BRIDGE_PORT          5577
+#endif
+
+#ifndef IP_BRIDGE_MCAST_GROUP
+  #define IP_BRIDGE_MCAST_GROUP   "239.255.67.77"   // (UDP only)
+#endif
+
+#ifndef IP_BRIDGE_MAX_PEERS
+  #define IP_BRIDGE_MAX_PEERS     4    // configured peers, plus (TCP only) accepted incoming connections
+#endif
+
+#ifndef IP_BRIDGE_BATCH_SIZE
+  #define IP_BRIDGE_BATCH_SIZE    600  // max bytes per datagram, or per TCP batch
+#endif
+
+#ifndef IP_BRIDGE_CONNECT_TIMEOUT_MILLIS
+  #define IP_BRIDGE_CONNECT_TIMEOUT_MILLIS  200   // (TCP only) max time loop() is blocked by a connect attempt
+#endif
+
+#ifndef IP_BRIDGE_REPLAY_WINDOW_SECS
+  #define IP_BRIDGE_REPLAY_WINDOW_SECS  120   // max clock difference allowed for authenticated batches
+#endif
+
+#ifndef IP_BRIDGE_REPLAY_CACHE_SIZE
+  #define IP_BRIDGE_REPLAY_CACHE_SIZE   32    // recent authenticated batches remembered, to reject replays
+#endif
+
+#define IP_BRIDGE_RECONNECT_MILLIS  10000   // (TCP only)
+#define IP_BRIDGE_HMAC_SIZE         8       // truncated HMAC-SHA256 tag
+#define IP_BRIDGE_AUTH_HEADER_SIZE  8       // timestamp + counter, in authenticated batches
+#define IP_BRIDGE_DEFAULT_SECRET    "LVSITANOS"   // the shipped default, which is public, so never used for HMAC
+
+/**
+ * @brief Bridge implementation carrying mesh packets over IP, for joining distant mesh islands via a backhaul
+ *
+ * Uses UDP by default: each batch is sent to a multicast group, and also unicast to any peers
+ * listed in WITH_IP_BRIDGE_PEERS. If WITH_IP_BRIDGE_TCP is defined, it instead keeps a TCP connection
+ * to each listed peer, and also accepts incoming connections on IP_BRIDGE_PORT.
+ *
+ * Features:
+ * - Several packets per datagram/TCP write (batched, then sent once per loop())
+ * - Optional HMAC-SHA256 authentication of batches, keyed by _prefs->bridge_secret, with replay protection
+ * - Duplicate packet detection using SimpleMeshTables tracking
+ * - Runs on ESP32 WiFi (station mode)
+ *
+ * Batch Structure:
+ * [2 bytes] Magic Header - Used to identify IPBridge batches
+ * [1 byte]  Version
+ * [1 byte]  Flags - IP_BRIDGE_FLAG_HMAC if authenticated
+ * if authenticated:
+ *   [4 bytes] Timestamp - sender's RTC clock (epoch secs)
+ *   [4 bytes] Counter - incremented for each batch sent
+ * for each packet:
+ *   [1 byte]  Length of packet
+ *   [n bytes] Mesh packet, as Packet::writeTo()
+ * [8 bytes] HMAC-SHA256 (truncated) over all of the above, if bridge_secret set,
+ *   else [2 bytes] Fletcher-16 checksum
+ * Over TCP, each batch is preceded by a 2-byte length.
+ *
+ * Configuration:
+ * - Define WITH_IP_BRIDGE to enable this bridge
+ * - Define WIFI_SSID and WIFI_PWD for the WiFi network to join
+ * - Define WITH_IP_BRIDGE_PEERS with a comma separated list of peer IP addresses (optional for UDP)
+ * - Define WITH_IP_BRIDGE_TCP to use TCP instead of UDP
+ * - Set _prefs->bridge_secret to require authenticated batches
+ *
+ * NOTE: authenticated batches are only accepted if their timestamp is within IP_BRIDGE_REPLAY_WINDOW_SECS
+ * of our clock, and not already in the recent batches cache, so all bridge nodes need their clocks set.
+ * The default bridge_secret (IP_BRIDGE_DEFAULT_SECRET) is public, so is treated the same as no secret.
+ */
+class IPBridge : public BridgeBase {
+  static constexpr uint8_t PROTOCOL_VERSION = 2;
+  static constexpr uint8_t IP_BRIDGE_FLAG_HMAC = 0x01;
+  static constexpr uint16_t BATCH_HEADER_SIZE = BRIDGE_MAGIC_SIZE + 2;
+
+  struct Peer {
+    IPAddress addr;
+    bool configured;       // from WITH_IP_BRIDGE_PEERS (otherwise an accepted incoming connection)
+#ifdef WITH_IP_BRIDGE_TCP
+    WiFiClient client;
+    uint8_t rx_buffer[2 + IP_BRIDGE_BATCH_SIZE];
+    uint16_t rx_len;
+    unsigned long next_connect;
+#endif
+  };
+
+  Peer _peers[IP_BRIDGE_MAX_PEERS];
+  int _num_peers;
+  bool _net_up;
+#ifdef WITH_IP_BRIDGE_TCP
+  WiFiServer _server;
+#else
+  WiFiUDP _udp;
+  IPAddress _mcast_group;
+#endif
+
+  /** Batch of outgoing packets */
+  uint8_t _tx_batch[IP_BRIDGE_BATCH_SIZE];
+  uint16_t _tx_len;
+  uint32_t _tx_counter;
+
+  /** Tags of recently received authenticated batches */
+  uint8_t _recent_tags[IP_BRIDGE_REPLAY_CACHE_SIZE][IP_BRIDGE_HMAC_SIZE];
+  int _next_recent;
+
+  bool hasSecret() const;
+  uint16_t getHeaderSize() const { return BATCH_HEADER_SIZE + (hasSecret() ? IP_BRIDGE_AUTH_HEADER_SIZE : 0); }
+  uint16_t getTagSize() const { return hasSecret() ? IP_BRIDGE_HMAC_SIZE : BRIDGE_CHECKSUM_SIZE; }
+  void calcAuthTag(const uint8_t *data, size_t len, uint8_t *tag);
+  bool isReplay(const uint8_t *data, const uint8_t *tag);
+
+  void startNetwork();
+  void stopNetwork();
+  void flushTx();
+  void sendBatch(const uint8_t *data, uint16_t len);
+  void recvBatch(const uint8_t *data, uint16_t len);
+#ifdef WITH_IP_BRIDGE_TCP
+  void checkTcpPeers();
+#endif
+
+public:
+  /**
+   * @brief Constructs an IPBridge instance
+   *
+   * @param prefs Node preferences for configuration settings
+   * @param mgr PacketManager for allocating and queuing packets
+   * @param rtc RTCClock for timestamping debug messages
+   */
+  IPBridge(NodePrefs *prefs, mesh::PacketManager *mgr, mesh::RTCClock *rtc);
+
+  /**
+   * Initializes the IP bridge
+   *
+   * - Starts joining the WiFi network (sockets are opened in loop(), once connected)
+   * - Warns if bridge_secret is the default, as batches are then not authenticated
+   */
+  void begin() override;
+
+  /**
+   * Stops the IP bridge
+   *
+   * - Closes all sockets, and turns off WiFi
+   */
+  void end() override;
+
+  /**
+   * @brief Main loop handler
+   *
+   * - (Re)opens sockets when WiFi connects, closes them if it drops
+   * - Receives batches, validates checksum or HMAC (and timestamp), and queues each packet to the mesh
+   * - (TCP) accepts incoming connections, and reconnects to configured peers (one attempt per loop)
+   * - Sends any batched packets
+   */
+  void loop() override;
+
+  /**
+   * Called when a packet is received via IP
+   * Queues the packet for mesh processing if not seen before
+   *
+   * @param packet The received mesh packet
+   */
+  void onPacketReceived(mesh::Packet *packet) override;
+
+  /**
+   * Called when a packet needs to be transmitted via IP
+   * Appends the packet to the current batch, if not seen before
+   *
+   * @param packet The mesh packet to transmit
+   */
+  void sendPacket(mesh::Packet *packet) override;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "RS232Bridge.h"
 
+#include <Arduino.h>
 #include <HardwareSerial.h>
 
 #ifdef WITH_RS232_BRIDGE
@@ -30,6 +31,13 @@ void RS232Bridge::begin() {
 
   // Update bridge state
   _initialized = true;
+
+  // assume v1 peer, until it answers our HELLO
+  _peer_version = 1;
+  _v2_errors = 0;
+  _rx_buffer_pos = _frame_len = _tx_len = 0;
+  _frame_overflow = false;
+  sendHello(false);
 }
 
 void RS232Bridge::end() {
@@ -40,68 +48,221 @@ void RS232Bridge::end() {
   _initialized = false;
 }
 
+// COBS encode 'len' bytes of 'src' into 'dest' (must have room for len + len/254 + 1), returns encoded length
+static uint16_t cobsEncode(const uint8_t *src, uint16_t len, uint8_t *dest) {
+  uint16_t code_idx = 0, out = 1;
+  uint8_t code = 1;
+  for (uint16_t i = 0; i < len; i++) {
+    if (src[i] == 0) {
+      dest[code_idx] = code;
+      code_idx = out++;
+      code = 1;
+    } else {
+      dest[out++] = src[i];
+      if (++code == 0xFF) {
+        dest[code_idx] = code;
+        code_idx = out++;
+        code = 1;
+      }
+    }
+  }
+  dest[code_idx] = code;
+  return out;
+}
+
+// COBS decode (in-place safe), returns decoded length, or -1 if malformed
+static int cobsDecode(const uint8_t *src, uint16_t len, uint8_t *dest) {
+  uint16_t in = 0, out = 0;
+  while (in < len) {
+    uint8_t code = src[in++];
+    if (code == 0 || in + code - 1 > len) return -1;
+    for (uint8_t i = 1; i < code; i++) {
+      dest[out++] = src[in++];
+    }
+    if (code < 0xFF && in < len) dest[out++] = 0;
+  }
+  return out;
+}
+
 void RS232Bridge::loop() {
   // Guard against uninitialized state
   if (_initialized == false) {
     return;
   }
 
-  while (_serial->available()) {
-    uint8_t b = _serial->read();
+  int avail;
+  while ((avail = _serial->available()) > 0) {
+    uint8_t chunk[RS232_BRIDGE_RX_CHUNK];
+    int n = _serial->readBytes(chunk, avail < (int)sizeof(chunk) ? avail : sizeof(chunk));
+    if (n <= 0) break;
 
-    if (_rx_buffer_pos < 2) {
-      // Waiting for magic word
-      if ((_rx_buffer_pos == 0 && b == ((BRIDGE_PACKET_MAGIC >> 8) & 0xFF)) ||
-          (_rx_buffer_pos == 1 && b == (BRIDGE_PACKET_MAGIC & 0xFF))) {
-        _rx_buffer[_rx_buffer_pos++] = b;
+    if (_peer_version < 2) {   // peer may still be v1
+      for (int i = 0; i < n; i++) {
+        recvByteV1(chunk[i]);
+      }
+    }
+
+    // split into v2 frames, at each 0x00 delimiter
+    const uint8_t *sp = chunk;
+    while (n > 0) {
+      const uint8_t *delim = (const uint8_t *)memchr(sp, 0, n);
+      int span = delim ? delim - sp : n;
+      if (_frame_len + span <= sizeof(_frame_buffer)) {
+        memcpy(&_frame_buffer[_frame_len], sp, span);
+        _frame_len += span;
       } else {
-        // Invalid magic byte, reset and start over
-        _rx_buffer_pos = 0;
-        // Check if this byte could be the start of a new magic word
-        if (b == ((BRIDGE_PACKET_MAGIC >> 8) & 0xFF)) {
-          _rx_buffer[_rx_buffer_pos++] = b;
-        }
+        _frame_overflow = true;   // discard, until next delimiter
       }
-    } else {
-      // Reading length, payload, and checksum
+      if (delim) {
+        if (_frame_len > 0 && !_frame_overflow) recvFrameV2();
+        _frame_len = 0;
+        _frame_overflow = false;
+        span++;
+      }
+      sp += span;
+      n -= span;
+    }
+  }
+
+  if (_peer_version < 2 && (long)(millis() - _next_hello) >= 0) {
+    sendHello(false);
+  }
+  flushTx();
+}
+
+void RS232Bridge::recvByteV1(uint8_t b) {
+  if (_rx_buffer_pos < 2) {
+    // Waiting for magic word
+    if ((_rx_buffer_pos == 0 && b == ((BRIDGE_PACKET_MAGIC >> 8) & 0xFF)) ||
+        (_rx_buffer_pos == 1 && b == (BRIDGE_PACKET_MAGIC & 0xFF))) {
       _rx_buffer[_rx_buffer_pos++] = b;
+    } else {
+      // Invalid magic byte, reset and start over
+      _rx_buffer_pos = 0;
+      // Check if this byte could be the start of a new magic word
+      if (b == ((BRIDGE_PACKET_MAGIC >> 8) & 0xFF)) {
+        _rx_buffer[_rx_buffer_pos++] = b;
+      }
+    }
+  } else {
+    // Reading length, payload, and checksum
+    _rx_buffer[_rx_buffer_pos++] = b;
 
-      if (_rx_buffer_pos >= 4) {
-        uint16_t len = (_rx_buffer[2] << 8) | _rx_buffer[3];
+    if (_rx_buffer_pos >= 4) {
+      uint16_t len = (_rx_buffer[2] << 8) | _rx_buffer[3];
 
-        // Validate length field
-        if (len > (MAX_TRANS_UNIT + 1)) {
-          BRIDGE_DEBUG_PRINTLN("RX invalid length %d, resetting\n", len);
-          _rx_buffer_pos = 0; // Invalid length, reset
-          continue;
-        }
+      // Validate length field
+      if (len > (MAX_TRANS_UNIT + 1)) {
+        BRIDGE_DEBUG_PRINTLN("RX invalid length %d, resetting\n", len);
+        _rx_buffer_pos = 0; // Invalid length, reset
+        return;
+      }
+
+      if (_rx_buffer_pos == len + SERIAL_OVERHEAD) { // Full packet received
+        uint16_t received_checksum = (_rx_buffer[4 + len] << 8) | _rx_buffer[5 + len];
 
-        if (_rx_buffer_pos == len + SERIAL_OVERHEAD) { // Full packet received
-          uint16_t received_checksum = (_rx_buffer[4 + len] << 8) | _rx_buffer[5 + len];
-
-          if (validateChecksum(_rx_buffer + 4, len, received_checksum)) {
-            BRIDGE_DEBUG_PRINTLN("RX, len=%d crc=0x%04x\n", len, received_checksum);
-            mesh::Packet *pkt = _mgr->allocNew();
-            if (pkt) {
-              if (pkt->readFrom(_rx_buffer + 4, len)) {
-                onPacketReceived(pkt);
-              } else {
-                BRIDGE_DEBUG_PRINTLN("RX failed to parse packet\n");
-                _mgr->free(pkt);
-              }
-            } else {
-              BRIDGE_DEBUG_PRINTLN("RX failed to allocate packet\n");
-            }
-          } else {
-            BRIDGE_DEBUG_PRINTLN("RX checksum mismatch, rcv=0x%04x\n", received_checksum);
-          }
-          _rx_buffer_pos = 0; // Reset for next packet
+        if (validateChecksum(_rx_buffer + 4, len, received_checksum)) {
+          BRIDGE_DEBUG_PRINTLN("RX, len=%d crc=0x%04x\n", len, received_checksum);
+          processFrameData(_rx_buffer + 4, len);
+        } else {
+          BRIDGE_DEBUG_PRINTLN("RX checksum mismatch, rcv=0x%04x\n", received_checksum);
         }
+        _rx_buffer_pos = 0; // Reset for next packet
       }
     }
   }
 }
 
+void RS232Bridge::recvFrameV2() {
+  uint8_t raw[MAX_V2_FRAME_SIZE];
+  int len = cobsDecode(_frame_buffer, _frame_len, raw);
+
+  if (len < 1 + BRIDGE_CHECKSUM_SIZE ||
+      crc16(raw, len - BRIDGE_CHECKSUM_SIZE) != ((raw[len - 2] << 8) | raw[len - 1])) {
+    if (_peer_version >= 2 && ++_v2_errors >= RS232_BRIDGE_MAX_V2_ERRORS) {
+      BRIDGE_DEBUG_PRINTLN("RX too many bad v2 frames, falling back to v1\n");
+      _peer_version = 1;
+      _v2_errors = 0;
+      _next_hello = millis();   // re-negotiate now
+    }
+    return;   // (in v1 mode, this is just a v1 frame, or noise)
+  }
+  _v2_errors = 0;
+  len -= BRIDGE_CHECKSUM_SIZE;
+
+  if (raw[0] == RS232_FRAME_PACKET) {
+    BRIDGE_DEBUG_PRINTLN("RX v2, len=%d\n", len - 1);
+    processFrameData(&raw[1], len - 1);
+  } else if (raw[0] == RS232_FRAME_HELLO && len >= 3) {
+    BRIDGE_DEBUG_PRINTLN("RX HELLO, version=%d\n", (uint32_t)raw[1]);
+    if (raw[1] >= 2) {
+      _peer_version = 2;
+      if ((raw[2] & RS232_HELLO_FLAG_REPLY) == 0) sendHello(true);
+    }
+  }
+}
+
+void RS232Bridge::processFrameData(const uint8_t *data, uint16_t len) {
+  mesh::Packet *pkt = _mgr->allocNew();
+  if (pkt) {
+    if (pkt->readFrom(data, len)) {
+      onPacketReceived(pkt);
+    } else {
+      BRIDGE_DEBUG_PRINTLN("RX failed to parse packet\n");
+      _mgr->free(pkt);
+    }
+  } else {
+    BRIDGE_DEBUG_PRINTLN("RX failed to allocate packet\n");
+  }
+}
+
+void RS232Bridge::queueFrameV1(const uint8_t *data, uint16_t len) {
+  if (_tx_len + len + SERIAL_OVERHEAD > sizeof(_tx_buffer)) flushTx();
+
+  uint8_t *buffer = &_tx_buffer[_tx_len];
+  // Build packet header
+  buffer[0] = (BRIDGE_PACKET_MAGIC >> 8) & 0xFF; // Magic high byte
+  buffer[1] = BRIDGE_PACKET_MAGIC & 0xFF;        // Magic low byte
+  buffer[2] = (len >> 8) & 0xFF;                 // Length high byte
+  buffer[3] = len & 0xFF;                        // Length low byte
+  memcpy(&buffer[4], data, len);
+
+  // Calculate checksum over the payload
+  uint16_t checksum = fletcher16(data, len);
+  buffer[4 + len] = (checksum >> 8) & 0xFF; // Checksum high byte
+  buffer[5 + len] = checksum & 0xFF;        // Checksum low byte
+
+  _tx_len += len + SERIAL_OVERHEAD;
+}
+
+void RS232Bridge::queueFrameV2(uint8_t type, const uint8_t *data, uint16_t len) {
+  uint8_t raw[MAX_V2_RAW_SIZE];
+  raw[0] = type;
+  memcpy(&raw[1], data, len);
+  uint16_t crc = crc16(raw, 1 + len);
+  raw[1 + len] = (crc >> 8) & 0xFF;
+  raw[2 + len] = crc & 0xFF;
+
+  if (_tx_len + MAX_V2_FRAME_SIZE + 1 > sizeof(_tx_buffer)) flushTx();
+  _tx_len += cobsEncode(raw, 3 + len, &_tx_buffer[_tx_len]);
+  _tx_buffer[_tx_len++] = 0;   // delimiter
+}
+
+void RS232Bridge::sendHello(bool reply) {
+  uint8_t data[2];
+  data[0] = PROTOCOL_VERSION;
+  data[1] = reply ? RS232_HELLO_FLAG_REPLY : 0;
+  queueFrameV2(RS232_FRAME_HELLO, data, sizeof(data));
+  _next_hello = millis() + RS232_BRIDGE_HELLO_MILLIS;
+}
+
+void RS232Bridge::flushTx() {
+  if (_tx_len > 0) {
+    _serial->write(_tx_buffer, _tx_len);
+    _tx_len = 0;
+  }
+}
+
 void RS232Bridge::sendPacket(mesh::Packet *packet) {
   // Guard against uninitialized state
   if (_initialized == false) {
@@ -116,8 +277,8 @@ void RS232Bridge::sendPacket(mesh::Packet *packet) {
 
   if (!_seen_packets.hasSeen(packet)) {
 
-    uint8_t buffer[MAX_SERIAL_PACKET_SIZE];
-    uint16_t len = packet->writeTo(buffer + 4);
+    uint8_t buffer[MAX_TRANS_UNIT + 1];
+    uint16_t len = packet->writeTo(buffer);
 
     // Check if packet fits within our maximum payload size
     if (len > (MAX_TRANS_UNIT + 1)) {
@@ -126,21 +287,12 @@ void RS232Bridge::sendPacket(mesh::Packet *packet) {
       return;
     }
 
-    // Build packet header
-    buffer[0] = (BRIDGE_PACKET_MAGIC >> 8) & 0xFF; // Magic high byte
-    buffer[1] = BRIDGE_PACKET_MAGIC & 0xFF;        // Magic low byte
-    buffer[2] = (len >> 8) & 0xFF;                 // Length high byte
-    buffer[3] = len & 0xFF;                        // Length low byte
-
-    // Calculate checksum over the payload
-    uint16_t checksum = fletcher16(buffer + 4, len);
-    buffer[4 + len] = (checksum >> 8) & 0xFF; // Checksum high byte
-    buffer[5 + len] = checksum & 0xFF;        // Checksum low byte
-
-    // Send complete packet
-    _serial->write(buffer, len + SERIAL_OVERHEAD);
-
-    BRIDGE_DEBUG_PRINTLN("TX, len=%d crc=0x%04x\n", len, checksum);
+    if (_peer_version >= 2) {
+      queueFrameV2(RS232_FRAME_PACKET, buffer, len);
+    } else {
+      queueFrameV1(buffer, len);
+    }
+    BRIDGE_DEBUG_PRINTLN("TX, len=%d v%d\n", len, (uint32_t)_peer_version);
   }
 }
 
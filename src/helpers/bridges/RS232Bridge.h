@@ -6,6 +6,17 @@
 
 #ifdef WITH_RS232_BRIDGE
 
+#ifndef RS232_BRIDGE_RX_CHUNK
+  #define RS232_BRIDGE_RX_CHUNK       64     // bytes read from serial at a time
+#endif
+
+#ifndef RS232_BRIDGE_TX_BUF_SIZE
+  #define RS232_BRIDGE_TX_BUF_SIZE   600     // frames are batched in this, then written once per loop()
+#endif
+
+#define RS232_BRIDGE_HELLO_MILLIS   30000    // how often to send HELLO, while peer is not known to be v2
+#define RS232_BRIDGE_MAX_V2_ERRORS      3    // consecutive bad v2 frames, before falling back to v1
+
 /**
  * @brief Bridge implementation using RS232/UART protocol for packet transport
  *
@@ -32,6 +43,16 @@
  * noise, timing issues, or hardware problems could corrupt data. The checksum
  * validation ensures only valid packets are forwarded to the mesh.
  *
+ * Protocol v2:
+ * On start-up, and periodically until a v2 peer answers, a HELLO frame is sent. Once the peer has
+ * sent a v2 HELLO, all traffic to it uses v2 frames, otherwise the v1 format above is used, so a v1
+ * peer keeps interoperating. v2 frames are COBS encoded, and terminated by a 0x00 delimiter
+ * (so the receiver resyncs at the next zero byte after any corruption):
+ * [1 byte] Frame Type - RS232_FRAME_PACKET or RS232_FRAME_HELLO
+ * [n bytes] Frame Data - the mesh packet, or HELLO version + flags
+ * [2 bytes] CRC-16/CCITT-FALSE - over type + data
+ * Serial input is read in bulk, and outgoing frames are batched, then written once per loop().
+ *
  * Configuration:
  * - Define WITH_RS232_BRIDGE to enable this bridge
  * - Define WITH_RS232_BRIDGE_RX with the RX pin number
@@ -75,24 +96,21 @@ public:
   /**
    * @brief Main loop handler for processing incoming serial data
    *
-   * Implements a state machine for packet reception:
-   * 1. Searches for magic header bytes for packet synchronization
-   * 2. Reads length field to determine expected packet size
-   * 3. Validates packet length against maximum allowed size
-   * 4. Receives complete packet payload and checksum
-   * 5. Validates Fletcher-16 checksum for data integrity
-   * 6. Creates mesh packet and forwards if valid
+   * Reads available serial data in chunks, then:
+   * 1. Splits v2 frames at each 0x00 delimiter, decodes COBS and validates CRC-16
+   * 2. Until peer is known to be v2, also runs the v1 state machine (magic, length, payload, Fletcher-16)
+   * 3. Creates mesh packet and forwards if valid
+   * Finally, sends a HELLO if due, and writes out any batched frames.
    */
   void loop() override;
 
   /**
    * @brief Called when a packet needs to be transmitted over serial
    *
-   * Formats the mesh packet with RS232 framing protocol:
-   * - Adds magic header for synchronization
-   * - Includes payload length field
-   * - Calculates Fletcher-16 checksum over payload
-   * - Transmits complete framed packet
+   * Formats the mesh packet as a v2 frame if peer supports it, otherwise v1:
+   * - v1: magic header, length field, payload, Fletcher-16 checksum
+   * - v2: COBS encoded type + payload + CRC-16, and 0x00 delimiter
+   * - Appends to the TX batch buffer (written out in loop())
    * - Uses duplicate detection to prevent retransmission
    *
    * @param packet The mesh packet to transmit
@@ -135,14 +153,48 @@ private:
    */
   static constexpr uint16_t MAX_SERIAL_PACKET_SIZE = (MAX_TRANS_UNIT + 1) + SERIAL_OVERHEAD;
 
+  /** v2 frame types, and protocol version */
+  static constexpr uint8_t RS232_FRAME_PACKET = 0x01;
+  static constexpr uint8_t RS232_FRAME_HELLO = 0x02;
+  static constexpr uint8_t RS232_HELLO_FLAG_REPLY = 0x01;
+  static constexpr uint8_t PROTOCOL_VERSION = 2;
+
+  /** Max v2 frame before COBS encoding: TYPE (1) + mesh packet + CRC (2) */
+  static constexpr uint16_t MAX_V2_RAW_SIZE = 1 + (MAX_TRANS_UNIT + 1) + BRIDGE_CHECKSUM_SIZE;
+
+  /** Max v2 frame after COBS encoding (one overhead byte per 254, plus one), excluding the delimiter */
+  static constexpr uint16_t MAX_V2_FRAME_SIZE = MAX_V2_RAW_SIZE + MAX_V2_RAW_SIZE / 254 + 1;
+
   /** Hardware serial port interface */
   Stream *_serial;
 
-  /** Buffer for building received packets */
+  /** Buffer for building received (v1) packets */
   uint8_t _rx_buffer[MAX_SERIAL_PACKET_SIZE];
 
   /** Current position in the receive buffer */
   uint16_t _rx_buffer_pos = 0;
+
+  /** Buffer for the v2 frame being received (still COBS encoded) */
+  uint8_t _frame_buffer[MAX_V2_FRAME_SIZE];
+  uint16_t _frame_len = 0;
+  bool _frame_overflow = false;
+
+  /** Batched outgoing frames */
+  uint8_t _tx_buffer[RS232_BRIDGE_TX_BUF_SIZE];
+  uint16_t _tx_len = 0;
+
+  /** Protocol version of peer (1 until it sends a v2 HELLO) */
+  uint8_t _peer_version = 1;
+  uint8_t _v2_errors = 0;
+  unsigned long _next_hello = 0;
+
+  void recvByteV1(uint8_t b);
+  void recvFrameV2();
+  void processFrameData(const uint8_t *data, uint16_t len);
+  void queueFrameV1(const uint8_t *data, uint16_t len);
+  void queueFrameV2(uint8_t type, const uint8_t *data, uint16_t len);
+  void sendHello(bool reply);
+  void flushTx();
 };
 
 #endif
@@ -15,7 +15,7 @@ void SerialBLEInterface::begin(const char* device_name, uint32_t pin_code) {
   // Create the BLE Device
   BLEDevice::init(device_name);
   BLEDevice::setSecurityCallbacks(this);
-  BLEDevice::setMTU(MAX_FRAME_SIZE);
+  BLEDevice::setMTU(BLE_MAX_MTU);
 
   BLESecurity  sec;
   sec.setStaticPIN(pin_code);
@@ -84,10 +84,12 @@ void SerialBLEInterface::onConnect(BLEServer* pServer) {
 void SerialBLEInterface::onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t *param) {
   BLE_DEBUG_PRINTLN("onConnect(), conn_id=%d, mtu=%d", param->connect.conn_id, pServer->getPeerMTU(param->connect.conn_id));
   last_conn_id = param->connect.conn_id;
+  _max_notify_len = pServer->getPeerMTU(last_conn_id) - 3;   // ATT header is 3 bytes
 }
 
 void SerialBLEInterface::onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
   BLE_DEBUG_PRINTLN("onMtuChanged(), mtu=%d", pServer->getPeerMTU(param->mtu.conn_id));
+  _max_notify_len = param->mtu.mtu - 3;
 }
 
 void SerialBLEInterface::onDisconnect(BLEServer* pServer) {
@@ -145,6 +147,7 @@ void SerialBLEInterface::disable() {
   pServer->disconnect(last_conn_id);
   pService->stop();
   oldDeviceConnected = deviceConnected = false;
+  _framed_stream = false;
   adv_restart_time = 0;
 }
 
@@ -155,13 +158,14 @@ size_t SerialBLEInterface::writeFrame(const uint8_t src[], size_t len) {
   }
 
   if (deviceConnected && len > 0) {
-    if (send_queue_len >= FRAME_QUEUE_SIZE) {
+    if (send_queue_len >= BLE_SEND_QUEUE_SIZE) {
       BLE_DEBUG_PRINTLN("writeFrame(), send_queue is full!");
       return 0;
     }
 
-    send_queue[send_queue_len].len = len;  // add to send queue
-    memcpy(send_queue[send_queue_len].buf, src, len);
+    Frame& f = send_queue[(send_queue_head + send_queue_len) % BLE_SEND_QUEUE_SIZE];  // add to send queue
+    f.len = len;
+    memcpy(f.buf, src, len);
     send_queue_len++;
 
     return len;
@@ -172,22 +176,55 @@ size_t SerialBLEInterface::writeFrame(const uint8_t src[], size_t len) {
 #define  BLE_WRITE_MIN_INTERVAL   60
 
 bool SerialBLEInterface::isWriteBusy() const {
+  if (_framed_stream) {
+    return send_queue_len >= BLE_SEND_QUEUE_SIZE - 2;   // keep some room for command responses
+  }
   return millis() < _last_write + BLE_WRITE_MIN_INTERVAL;   // still too soon to start another write?
 }
 
+int SerialBLEInterface::countPackableFrames() const {
+  int max_len = _max_notify_len;
+  if (max_len > BLE_MAX_MTU - 3) max_len = BLE_MAX_MTU - 3;
+
+  int n = 0;
+  int len = 1;  // FRAME_STREAM_PACKED
+  while (n < send_queue_len) {
+    len += 1 + send_queue[(send_queue_head + n) % BLE_SEND_QUEUE_SIZE].len;
+    if (len > max_len) break;
+    n++;
+  }
+  return n;
+}
+
 size_t SerialBLEInterface::checkRecvFrame(uint8_t dest[]) {
   if (send_queue_len > 0   // first, check send queue
     && millis() >= _last_write + BLE_WRITE_MIN_INTERVAL    // space the writes apart
   ) {
     _last_write = millis();
-    pTxCharacteristic->setValue(send_queue[0].buf, send_queue[0].len);
-    pTxCharacteristic->notify();
 
-    BLE_DEBUG_PRINTLN("writeBytes: sz=%d, hdr=%d", (uint32_t)send_queue[0].len, (uint32_t) send_queue[0].buf[0]);
+    int n = _framed_stream ? countPackableFrames() : 1;
+    if (n > 1) {
+      uint8_t buf[BLE_MAX_MTU];
+      int len = 0;
+      buf[len++] = FRAME_STREAM_PACKED;
+      for (int i = 0; i < n; i++) {
+        const Frame& f = send_queue[send_queue_head];
+        buf[len++] = f.len;
+        memcpy(&buf[len], f.buf, f.len); len += f.len;
+        popSendFrame();
+      }
+      pTxCharacteristic->setValue(buf, len);
+      pTxCharacteristic->notify();
+
+      BLE_DEBUG_PRINTLN("writeBytes: sz=%d, packed frames=%d", len, n);
+    } else {
+      const Frame& f = send_queue[send_queue_head];
+      pTxCharacteristic->setValue((uint8_t *) f.buf, f.len);
+      pTxCharacteristic->notify();
+
+      BLE_DEBUG_PRINTLN("writeBytes: sz=%d, hdr=%d", (uint32_t)f.len, (uint32_t) f.buf[0]);
 
-    send_queue_len--;
-    for (int i = 0; i < send_queue_len; i++) {   // delete top item from queue
-      send_queue[i] = send_queue[i + 1];
+      popSendFrame();
     }
   }
 
@@ -209,6 +246,7 @@ size_t SerialBLEInterface::checkRecvFrame(uint8_t dest[]) {
   if (deviceConnected != oldDeviceConnected) {
     if (!deviceConnected) {    // disconnecting
       clearBuffers();
+      _framed_stream = false;
 
       BLE_DEBUG_PRINTLN("SerialBLEInterface -> disconnecting...");
 
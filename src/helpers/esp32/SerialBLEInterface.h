@@ -6,6 +6,14 @@
 #include <BLEUtils.h>
 #include <BLE2902.h>
 
+#ifndef BLE_MAX_MTU
+  #define BLE_MAX_MTU  512
+#endif
+
+#ifndef BLE_SEND_QUEUE_SIZE
+  #define BLE_SEND_QUEUE_SIZE  12
+#endif
+
 class SerialBLEInterface : public BaseSerialInterface, BLESecurityCallbacks, BLEServerCallbacks, BLECharacteristicCallbacks {
   BLEServer *pServer;
   BLEService *pService;
@@ -17,6 +25,8 @@ class SerialBLEInterface : public BaseSerialInterface, BLESecurityCallbacks, BLE
   uint32_t _pin_code;
   unsigned long _last_write;
   unsigned long adv_restart_time;
+  uint16_t _max_notify_len;
+  bool _framed_stream;
 
   struct Frame {
     uint8_t len;
@@ -26,10 +36,15 @@ class SerialBLEInterface : public BaseSerialInterface, BLESecurityCallbacks, BLE
   #define FRAME_QUEUE_SIZE  4
   int recv_queue_len;
   Frame recv_queue[FRAME_QUEUE_SIZE];
-  int send_queue_len;
-  Frame send_queue[FRAME_QUEUE_SIZE];
+  int send_queue_head, send_queue_len;
+  Frame send_queue[BLE_SEND_QUEUE_SIZE];   // cyclic
 
-  void clearBuffers() { recv_queue_len = 0; send_queue_len = 0; }
+  void clearBuffers() { recv_queue_len = 0; send_queue_head = send_queue_len = 0; }
+  void popSendFrame() {
+    send_queue_head = (send_queue_head + 1) % BLE_SEND_QUEUE_SIZE;
+    send_queue_len--;
+  }
+  int countPackableFrames() const;
 
 protected:
   // BLESecurityCallbacks methods
@@ -58,7 +73,9 @@ public:
     _isEnabled = false;
     _last_write = 0;
     last_conn_id = 0;
-    send_queue_len = recv_queue_len = 0;
+    _max_notify_len = MAX_FRAME_SIZE;
+    _framed_stream = false;
+    send_queue_head = send_queue_len = recv_queue_len = 0;
   }
 
   void begin(const char* device_name, uint32_t pin_code);
@@ -73,6 +90,7 @@ public:
   bool isWriteBusy() const override;
   size_t writeFrame(const uint8_t src[], size_t len) override;
   size_t checkRecvFrame(uint8_t dest[]) override;
+  bool setFramedStream(bool enable) override { _framed_stream = enable; return true; }
 };
 
 #if BLE_DEBUG_LOGGING && ARDUINO
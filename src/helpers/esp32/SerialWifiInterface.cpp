@@ -1,11 +1,34 @@
 #include "SerialWifiInterface.h"
 #include <WiFi.h>
 
+#define RECV_STATE_IDLE        0
+#define RECV_STATE_HDR_FOUND   1
+#define RECV_STATE_LEN1_FOUND  2
+#define RECV_STATE_LEN2_FOUND  3
+
+void SerialWifiInterface::ClientSlot::reset() {
+  connected = false;
+  last_activity = 0;
+  recv_state = RECV_STATE_IDLE;
+  frame_len = rx_len = 0;
+  send_queue_head = send_queue_len = 0;
+  send_ofs = 0;
+}
+
 void SerialWifiInterface::begin(int port) {
   // wifi setup is handled outside of this class, only starts the server
   server.begin(port);
 }
 
+void SerialWifiInterface::clearBuffers() {
+  for (int i = 0; i < WIFI_MAX_CLIENTS; i++) {
+    clients[i].recv_state = RECV_STATE_IDLE;
+    clients[i].send_queue_head = clients[i].send_queue_len = 0;
+    clients[i].send_ofs = 0;
+  }
+  _stream_idx = STREAM_NONE;
+}
+
 // ---------- public methods
 void SerialWifiInterface::enable() { 
   if (_isEnabled) return;
@@ -18,87 +41,203 @@ void SerialWifiInterface::disable() {
   _isEnabled = false;
 }
 
+bool SerialWifiInterface::addToSendQueue(ClientSlot& slot, const uint8_t src[], size_t len) {
+  if (slot.send_queue_len >= WIFI_SEND_QUEUE_SIZE) {
+    WIFI_DEBUG_PRINTLN("writeFrame(), send_queue is full!");
+    return false;
+  }
+  Frame& f = slot.send_queue[(slot.send_queue_head + slot.send_queue_len) % WIFI_SEND_QUEUE_SIZE];
+  f.len = len;
+  memcpy(f.buf, src, len);
+  slot.send_queue_len++;
+  return true;
+}
+
 size_t SerialWifiInterface::writeFrame(const uint8_t src[], size_t len) {
   if (len > MAX_FRAME_SIZE) {
     WIFI_DEBUG_PRINTLN("writeFrame(), frame too big, len=%d\n", len);
     return 0;
   }
+  if (len == 0) return 0;
 
-  if (deviceConnected && len > 0) {
-    if (send_queue_len >= FRAME_QUEUE_SIZE) {
-      WIFI_DEBUG_PRINTLN("writeFrame(), send_queue is full!");
-      return 0;
+  if (src[0] >= WIFI_PUSH_CODE_MIN) {   // fan-out push frames to all subscribers
+    bool sent = false;
+    for (int i = 0; i < WIFI_MAX_CLIENTS; i++) {
+      if (clients[i].connected && addToSendQueue(clients[i], src, len)) sent = true;
     }
+    return sent ? len : 0;
+  }
 
-    send_queue[send_queue_len].len = len;  // add to send queue
-    memcpy(send_queue[send_queue_len].buf, src, len);
-    send_queue_len++;
-
+  // otherwise, a reply to the client which started the current stream, or which sent the last command
+  int idx = _stream_idx == STREAM_NONE ? _reply_idx : _stream_idx;
+  if (idx >= 0 && clients[idx].connected && addToSendQueue(clients[idx], src, len)) {
     return len;
   }
   return 0;
 }
 
 bool SerialWifiInterface::isWriteBusy() const {
+  // any client backing up, as push frames go to all of them
+  for (int i = 0; i < WIFI_MAX_CLIENTS; i++) {
+    if (clients[i].connected && clients[i].send_queue_len >= WIFI_SEND_QUEUE_SIZE - 2) return true;   // keep some room for command responses
+  }
   return false;
 }
 
-size_t SerialWifiInterface::checkRecvFrame(uint8_t dest[]) {
-  // check if new client connected
-  auto newClient = server.available();
-  if (newClient) {
+void SerialWifiInterface::setReplyStream(bool active) {
+  _stream_idx = active ? _reply_idx : STREAM_NONE;
+}
+
+void SerialWifiInterface::dropClient(int idx) {
+  clients[idx].client.stop();
+  clients[idx].reset();
+  if (_reply_idx == idx) _reply_idx = -1;
+  if (_stream_idx == idx) _stream_idx = STREAM_ORPHANED;   // rest of stream is discarded, not sent to next client in slot
+}
 
-    // disconnect existing client
-    deviceConnected = false;
-    client.stop();
+void SerialWifiInterface::acceptClients() {
+  auto newClient = server.available();
+  if (!newClient) return;
 
-    // switch active connection to new client
-    client = newClient;
-    
+  // find free slot, otherwise evict the least recently active client
+  int idx = -1;
+  for (int i = 0; i < WIFI_MAX_CLIENTS; i++) {
+    if (!clients[i].connected) { idx = i; break; }
+    if (idx < 0 || clients[i].last_activity < clients[idx].last_activity) idx = i;
+  }
+  if (clients[idx].connected) {
+    WIFI_DEBUG_PRINTLN("Max clients, dropping client %d", idx);
   }
 
-  if (client.connected()) {
-    if (!deviceConnected) {
-      WIFI_DEBUG_PRINTLN("Got connection");
-      deviceConnected = true;
-    }
-  } else {
-    if (deviceConnected) {
-      deviceConnected = false;
-      WIFI_DEBUG_PRINTLN("Disconnected");
+  dropClient(idx);
+  clients[idx].client = newClient;
+  clients[idx].client.setNoDelay(true);
+  clients[idx].connected = true;
+  clients[idx].last_activity = millis();
+  WIFI_DEBUG_PRINTLN("Got connection, client %d", idx);
+}
+
+void SerialWifiInterface::flushSendQueue(ClientSlot& slot) {
+  int len = 0;
+  int skip = slot.send_ofs;   // resume a partly written head frame
+  for (int k = 0; k < slot.send_queue_len; k++) {
+    const Frame& f = slot.send_queue[(slot.send_queue_head + k) % WIFI_SEND_QUEUE_SIZE];
+    if (len + 3 + f.len - skip > WIFI_WRITE_BATCH_SIZE) break;   // rest in next write
+
+    // use same header as serial interface so client can delimit frames
+    uint8_t hdr[3] = { '>', (uint8_t)(f.len & 0xFF), 0 };   // LSB, MSB
+    for (int j = skip; j < 3; j++) write_buf[len++] = hdr[j];
+    int body_ofs = skip > 3 ? skip - 3 : 0;
+    memcpy(&write_buf[len], &f.buf[body_ofs], f.len - body_ofs); len += f.len - body_ofs;
+    skip = 0;
+  }
+  if (len == 0) return;
+
+  _last_write = millis();
+  size_t n = slot.client.write(write_buf, len);
+
+  // only remove what was actually written, so a short write can't break the framing
+  while (n > 0 && slot.send_queue_len > 0) {
+    const Frame& f = slot.send_queue[slot.send_queue_head];
+    size_t remaining = 3 + f.len - slot.send_ofs;
+    if (n < remaining) {
+      slot.send_ofs += n;
+      break;
     }
+    n -= remaining;
+    slot.send_ofs = 0;
+    slot.send_queue_head = (slot.send_queue_head + 1) % WIFI_SEND_QUEUE_SIZE;
+    slot.send_queue_len--;
   }
+}
 
-  if (deviceConnected) {
-    if (send_queue_len > 0) {   // first, check send queue
-      
-      _last_write = millis();
-      int len = send_queue[0].len;
-
-      uint8_t pkt[3+len]; // use same header as serial interface so client can delimit frames
-      pkt[0] = '>';
-      pkt[1] = (len & 0xFF);  // LSB
-      pkt[2] = (len >> 8);    // MSB
-      memcpy(&pkt[3], send_queue[0].buf, send_queue[0].len);
-      client.write(pkt, 3 + len);
-      send_queue_len--;
-      for (int i = 0; i < send_queue_len; i++) {   // delete top item from queue
-        send_queue[i] = send_queue[i + 1];
+size_t SerialWifiInterface::readFrame(ClientSlot& slot, uint8_t dest[]) {
+  while (slot.client.available() > 0) {
+    if (slot.recv_state == RECV_STATE_LEN2_FOUND) {   // bulk read remainder of frame body
+      int want = slot.frame_len - slot.rx_len;
+      int n;
+      if (slot.rx_len < MAX_FRAME_SIZE) {
+        if (want > MAX_FRAME_SIZE - slot.rx_len) want = MAX_FRAME_SIZE - slot.rx_len;
+        n = slot.client.read(&slot.rx_buf[slot.rx_len], want);
+      } else {
+        uint8_t discard[32];   // rest of frame will be discarded if > MAX
+        n = slot.client.read(discard, want < sizeof(discard) ? want : sizeof(discard));
       }
-    } else {
-      int len = client.available();
-      if (len > 0) {
-        uint8_t buf[MAX_FRAME_SIZE + 4];
-        client.readBytes(buf, len);
-        memcpy(dest, buf+3, len-3); // remove header (don't even check ... problems are on the other dir)
-        return len-3;
+      if (n <= 0) break;
+      slot.rx_len += n;
+
+      if (slot.rx_len >= slot.frame_len) {  // received a complete frame?
+        size_t len = slot.frame_len > MAX_FRAME_SIZE ? MAX_FRAME_SIZE : slot.frame_len;    // truncate
+        memcpy(dest, slot.rx_buf, len);
+        slot.recv_state = RECV_STATE_IDLE;  // reset state, for next frame
+        return len;
       }
+      continue;
+    }
+
+    int c = slot.client.read();
+    if (c < 0) break;
+
+    switch (slot.recv_state) {
+      case RECV_STATE_IDLE:
+        if (c == '<') {
+          slot.recv_state = RECV_STATE_HDR_FOUND;
+        }
+        break;
+      case RECV_STATE_HDR_FOUND:
+        slot.frame_len = (uint8_t)c;   // LSB
+        slot.recv_state = RECV_STATE_LEN1_FOUND;
+        break;
+      default:   // RECV_STATE_LEN1_FOUND
+        slot.frame_len |= ((uint16_t)c) << 8;   // MSB
+        slot.rx_len = 0;
+        slot.recv_state = slot.frame_len > 0 ? RECV_STATE_LEN2_FOUND : RECV_STATE_IDLE;
+        break;
+    }
+  }
+  return 0;
+}
+
+size_t SerialWifiInterface::checkRecvFrame(uint8_t dest[]) {
+  acceptClients();
+
+  for (int i = 0; i < WIFI_MAX_CLIENTS; i++) {
+    ClientSlot& slot = clients[i];
+    if (slot.connected && !slot.client.connected()) {
+      WIFI_DEBUG_PRINTLN("Disconnected, client %d", i);
+      dropClient(i);
+    }
+  }
+
+  for (int i = 0; i < WIFI_MAX_CLIENTS; i++) {   // first, flush send queues (all queued frames in one write)
+    if (clients[i].connected) flushSendQueue(clients[i]);
+  }
+
+  for (int k = 0; k < WIFI_MAX_CLIENTS; k++) {   // round-robin, so one busy client can't starve the others
+    int i = (_next_recv_idx + k) % WIFI_MAX_CLIENTS;
+    if (!clients[i].connected) continue;
+    if (_stream_idx != STREAM_NONE && i != _stream_idx) continue;   // hold back other clients until stream ends
+
+    size_t len = readFrame(clients[i], dest);
+    if (len > 0) {
+      clients[i].last_activity = millis();
+      _reply_idx = i;
+      _next_recv_idx = (i + 1) % WIFI_MAX_CLIENTS;
+      return len;
     }
   }
 
   return 0;
 }
 
+int SerialWifiInterface::getNumConnected() const {
+  int n = 0;
+  for (int i = 0; i < WIFI_MAX_CLIENTS; i++) {
+    if (clients[i].connected) n++;
+  }
+  return n;
+}
+
 bool SerialWifiInterface::isConnected() const {
-  return deviceConnected;  //pServer != NULL && pServer->getConnectedCount() > 0;
-}
\ No newline at end of file
+  return getNumConnected() > 0;
+}
@@ -3,40 +3,87 @@
 #include "../BaseSerialInterface.h"
 #include <WiFi.h>
 
+#ifndef WIFI_MAX_CLIENTS
+  #define WIFI_MAX_CLIENTS  4
+#endif
+
+#ifndef WIFI_SEND_QUEUE_SIZE
+  #define WIFI_SEND_QUEUE_SIZE  8    // per client
+#endif
+
+#ifndef WIFI_WRITE_BATCH_SIZE
+  #define WIFI_WRITE_BATCH_SIZE  1024   // max bytes of queued frames combined into one TCP write
+#endif
+
+#define WIFI_PUSH_CODE_MIN  0x80   // frames with first byte >= this are PUSH_CODE_*, and go to ALL clients
+
+#define STREAM_NONE       -1
+#define STREAM_ORPHANED   -2   // client disconnected mid-stream, rest of the reply is discarded
+
+/**
+ * \brief  TCP server for companion apps, with up to WIFI_MAX_CLIENTS connected at once.
+ *         PUSH_CODE_* frames go to all clients, replies go to the client which sent the command.
+ *         NOTE: the app's state (eg. offline message queue) is shared by all clients, so a message taken with
+ *         CMD_SYNC_NEXT_MESSAGE by one client is not delivered to the others.
+ */
 class SerialWifiInterface : public BaseSerialInterface {
-  bool deviceConnected;
   bool _isEnabled;
   unsigned long _last_write;
-  unsigned long adv_restart_time;
 
   WiFiServer server;
-  WiFiClient client;
 
   struct Frame {
     uint8_t len;
     uint8_t buf[MAX_FRAME_SIZE];
   };
 
-  #define FRAME_QUEUE_SIZE  4
-  int recv_queue_len;
-  Frame recv_queue[FRAME_QUEUE_SIZE];
-  int send_queue_len;
-  Frame send_queue[FRAME_QUEUE_SIZE];
+  struct ClientSlot {
+    WiFiClient client;
+    bool connected;
+    unsigned long last_activity;
+
+    uint8_t recv_state;
+    uint16_t frame_len, rx_len;
+    uint8_t rx_buf[MAX_FRAME_SIZE];
 
-  void clearBuffers() { recv_queue_len = 0; send_queue_len = 0; }
+    int send_queue_head, send_queue_len;
+    int send_ofs;   // bytes of the head frame (incl. header) already written
+    Frame send_queue[WIFI_SEND_QUEUE_SIZE];   // cyclic
+
+    void reset();
+  };
+
+  ClientSlot clients[WIFI_MAX_CLIENTS];
+  int _reply_idx;   // the client which sent the most recent command frame
+  int _stream_idx;  // client receiving a multi-pass reply, or STREAM_NONE / STREAM_ORPHANED
+  int _next_recv_idx;
+  uint8_t write_buf[WIFI_WRITE_BATCH_SIZE];
+
+  void clearBuffers();
+  void acceptClients();
+  void dropClient(int idx);
+  bool addToSendQueue(ClientSlot& slot, const uint8_t src[], size_t len);
+  void flushSendQueue(ClientSlot& slot);
+  size_t readFrame(ClientSlot& slot, uint8_t dest[]);
 
 protected:
 
 public:
-  SerialWifiInterface() : server(WiFiServer()), client(WiFiClient()) {
-    deviceConnected = false;
+  SerialWifiInterface() : server(WiFiServer()) {
     _isEnabled = false;
     _last_write = 0;
-    send_queue_len = recv_queue_len = 0;
+    _reply_idx = -1;
+    _stream_idx = STREAM_NONE;
+    _next_recv_idx = 0;
+    for (int i = 0; i < WIFI_MAX_CLIENTS; i++) {
+      clients[i].reset();
+    }
   }
 
   void begin(int port);
 
+  int getNumConnected() const;
+
   // BaseSerialInterface methods
   void enable() override;
   void disable() override;
@@ -44,6 +91,7 @@ public:
 
   bool isConnected() const override;
   bool isWriteBusy() const override;
+  void setReplyStream(bool active) override;
 
   size_t writeFrame(const uint8_t src[], size_t len) override;
   size_t checkRecvFrame(uint8_t dest[]) override;
@@ -4,6 +4,9 @@ static SerialBLEInterface* instance;
 
 void SerialBLEInterface::onConnect(uint16_t connection_handle) {
   BLE_DEBUG_PRINTLN("SerialBLEInterface: connected");
+  if(instance){
+    instance->_conn_handle = connection_handle;
+  }
   // we now set _isDeviceConnected=true in onSecured callback instead
 }
 
@@ -11,6 +14,8 @@ void SerialBLEInterface::onDisconnect(uint16_t connection_handle, uint8_t reason
   BLE_DEBUG_PRINTLN("SerialBLEInterface: disconnected reason=%d", reason);
   if(instance){
     instance->_isDeviceConnected = false;
+    instance->_framed_stream = false;
+    instance->_conn_handle = BLE_CONN_HANDLE_INVALID;
     instance->startAdv();
   }
 }
@@ -145,13 +150,14 @@ size_t SerialBLEInterface::writeFrame(const uint8_t src[], size_t len) {
   }
 
   if (_isDeviceConnected && len > 0) {
-    if (send_queue_len >= FRAME_QUEUE_SIZE) {
+    if (send_queue_len >= BLE_SEND_QUEUE_SIZE) {
       BLE_DEBUG_PRINTLN("writeFrame(), send_queue is full!");
       return 0;
     }
 
-    send_queue[send_queue_len].len = len;  // add to send queue
-    memcpy(send_queue[send_queue_len].buf, src, len);
+    Frame& f = send_queue[(send_queue_head + send_queue_len) % BLE_SEND_QUEUE_SIZE];  // add to send queue
+    f.len = len;
+    memcpy(f.buf, src, len);
     send_queue_len++;
 
     return len;
@@ -162,20 +168,55 @@ size_t SerialBLEInterface::writeFrame(const uint8_t src[], size_t len) {
 #define  BLE_WRITE_MIN_INTERVAL   60
 
 bool SerialBLEInterface::isWriteBusy() const {
+  if (_framed_stream) {
+    return send_queue_len >= BLE_SEND_QUEUE_SIZE - 2;   // keep some room for command responses
+  }
   return millis() < _last_write + BLE_WRITE_MIN_INTERVAL;   // still too soon to start another write?
 }
 
+int SerialBLEInterface::countPackableFrames() const {
+  int max_len = 20;   // default ATT MTU (23), less header
+  BLEConnection* conn = Bluefruit.Connection(_conn_handle);
+  if (conn) {
+    max_len = conn->getMtu() - 3;
+  }
+  if (max_len > BLE_MAX_NOTIFY_LEN) max_len = BLE_MAX_NOTIFY_LEN;
+
+  int n = 0;
+  int len = 1;  // FRAME_STREAM_PACKED
+  while (n < send_queue_len) {
+    len += 1 + send_queue[(send_queue_head + n) % BLE_SEND_QUEUE_SIZE].len;
+    if (len > max_len) break;
+    n++;
+  }
+  return n;
+}
+
 size_t SerialBLEInterface::checkRecvFrame(uint8_t dest[]) {
   if (send_queue_len > 0   // first, check send queue
     && millis() >= _last_write + BLE_WRITE_MIN_INTERVAL    // space the writes apart
   ) {
     _last_write = millis();
-    bleuart.write(send_queue[0].buf, send_queue[0].len);
-    BLE_DEBUG_PRINTLN("writeBytes: sz=%d, hdr=%d", (uint32_t)send_queue[0].len, (uint32_t) send_queue[0].buf[0]);
 
-    send_queue_len--;
-    for (int i = 0; i < send_queue_len; i++) {   // delete top item from queue
-      send_queue[i] = send_queue[i + 1];
+    int n = _framed_stream ? countPackableFrames() : 1;
+    if (n > 1) {
+      uint8_t buf[BLE_MAX_NOTIFY_LEN];
+      int len = 0;
+      buf[len++] = FRAME_STREAM_PACKED;
+      for (int i = 0; i < n; i++) {
+        const Frame& f = send_queue[send_queue_head];
+        buf[len++] = f.len;
+        memcpy(&buf[len], f.buf, f.len); len += f.len;
+        popSendFrame();
+      }
+      bleuart.write(buf, len);
+      BLE_DEBUG_PRINTLN("writeBytes: sz=%d, packed frames=%d", len, n);
+    } else {
+      const Frame& f = send_queue[send_queue_head];
+      bleuart.write(f.buf, f.len);
+      BLE_DEBUG_PRINTLN("writeBytes: sz=%d, hdr=%d", (uint32_t)f.len, (uint32_t) f.buf[0]);
+
+      popSendFrame();
     }
   } else {
     int len = bleuart.available();
@@ -7,22 +7,34 @@
 #define BLE_TX_POWER 4
 #endif
 
+#ifndef BLE_SEND_QUEUE_SIZE
+#define BLE_SEND_QUEUE_SIZE 12
+#endif
+
+#define BLE_MAX_NOTIFY_LEN  247   // max notify payload for the MTU (250) configured in begin()
+
 class SerialBLEInterface : public BaseSerialInterface {
   BLEUart bleuart;
   bool _isEnabled;
   bool _isDeviceConnected;
   unsigned long _last_write;
+  uint16_t _conn_handle;
+  bool _framed_stream;
 
   struct Frame {
     uint8_t len;
     uint8_t buf[MAX_FRAME_SIZE];
   };
 
-  #define FRAME_QUEUE_SIZE  4
-  int send_queue_len;
-  Frame send_queue[FRAME_QUEUE_SIZE];
+  int send_queue_head, send_queue_len;
+  Frame send_queue[BLE_SEND_QUEUE_SIZE];   // cyclic
 
-  void clearBuffers() { send_queue_len = 0; }
+  void clearBuffers() { send_queue_head = send_queue_len = 0; }
+  void popSendFrame() {
+    send_queue_head = (send_queue_head + 1) % BLE_SEND_QUEUE_SIZE;
+    send_queue_len--;
+  }
+  int countPackableFrames() const;
   static void onConnect(uint16_t connection_handle);
   static void onDisconnect(uint16_t connection_handle, uint8_t reason);
   static void onSecured(uint16_t connection_handle);
@@ -32,7 +44,9 @@ public:
     _isEnabled = false;
     _isDeviceConnected = false;
     _last_write = 0;
-    send_queue_len = 0;
+    _conn_handle = BLE_CONN_HANDLE_INVALID;
+    _framed_stream = false;
+    send_queue_head = send_queue_len = 0;
   }
 
   void startAdv();
@@ -49,6 +63,7 @@ public:
   bool isWriteBusy() const override;
   size_t writeFrame(const uint8_t src[], size_t len) override;
   size_t checkRecvFrame(uint8_t dest[]) override;
+  bool setFramedStream(bool enable) override { _framed_stream = enable; return true; }
 };
 
 #if BLE_DEBUG_LOGGING && ARDUINO
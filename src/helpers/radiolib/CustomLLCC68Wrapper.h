@@ -15,8 +15,7 @@ public:
   float getLastRSSI() const override { return ((CustomLLCC68 *)_radio)->getRSSI(); }
   float getLastSNR() const override { return ((CustomLLCC68 *)_radio)->getSNR(); }
 
-  float packetScore(float snr, int packet_len) override {
-    int sf = ((CustomLLCC68 *)_radio)->spreadingFactor;
-    return packetScoreInt(snr, sf, packet_len);
-  }
+  uint8_t getSpreadingFactor() const override { return ((CustomLLCC68 *)_radio)->spreadingFactor; }
+  float getBandwidth() const override { return ((CustomLLCC68 *)_radio)->bandwidthKhz; }
+  uint8_t getCodingRate() const override { return ((CustomLLCC68 *)_radio)->codingRate; }
 };
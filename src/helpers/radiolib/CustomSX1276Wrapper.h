@@ -15,8 +15,7 @@ public:
   float getLastRSSI() const override { return ((CustomSX1276 *)_radio)->getRSSI(); }
   float getLastSNR() const override { return ((CustomSX1276 *)_radio)->getSNR(); }
 
-  float packetScore(float snr, int packet_len) override {
-    int sf = ((CustomSX1276 *)_radio)->spreadingFactor;
-    return packetScoreInt(snr, sf, packet_len);
-  }
+  uint8_t getSpreadingFactor() const override { return ((CustomSX1276 *)_radio)->spreadingFactor; }
+  float getBandwidth() const override { return ((CustomSX1276 *)_radio)->bandwidth; }
+  uint8_t getCodingRate() const override { return ((CustomSX1276 *)_radio)->codingRate; }
 };
@@ -35,6 +35,9 @@ void RadioLibWrapper::begin() {
   _noise_floor = 0;
   _threshold = 0;
 
+  _table_sf = 0;   // force rebuild, for params set by radio_init()
+  checkParamsChanged();
+
   // start average out some samples
   _num_floor_samples = 0;
   _floor_sample_sum = 0;
@@ -124,7 +127,30 @@ int RadioLibWrapper::recvRaw(uint8_t* bytes, int sz) {
   return len;
 }
 
+void RadioLibWrapper::checkParamsChanged() {
+  // NOTE: radio_set_params() changes these directly on the radio, so compare with what the table was built for
+  uint8_t sf = getSpreadingFactor(), cr = getCodingRate();
+  float bw = getBandwidth();
+  if (sf == _table_sf && bw == _table_bw && cr == _table_cr) return;
+
+  _table_sf = sf; _table_bw = bw; _table_cr = cr;
+  if (cr) {
+    // getTimeOnAir() is floating point symbol math, so do it just once per length
+    for (int len = 0; len < AIRTIME_TABLE_SIZE; len++) {
+      _airtime[len] = _radio->getTimeOnAir(len) / 1000;
+    }
+  }
+  _scorer->setRadioParams(sf, bw);
+}
+
+void RadioLibWrapper::setPacketScorer(PacketScorer* scorer) {
+  _scorer = scorer ? scorer : &_default_scorer;
+  _scorer->setRadioParams(getSpreadingFactor(), getBandwidth());
+}
+
 uint32_t RadioLibWrapper::getEstAirtimeFor(int len_bytes) {
+  checkParamsChanged();
+  if (_table_cr && len_bytes >= 0 && len_bytes < AIRTIME_TABLE_SIZE) return _airtime[len_bytes];
   return _radio->getTimeOnAir(len_bytes) / 1000;
 }
 
@@ -168,23 +194,3 @@ float RadioLibWrapper::getLastSNR() const {
   return _radio->getSNR();
 }
 
-// Approximate SNR threshold per SF for successful reception (based on Semtech datasheets)
-static float snr_threshold[] = {
-    -7.5,  // SF7 needs at least -7.5 dB SNR
-    -10,   // SF8 needs at least -10 dB SNR
-    -12.5, // SF9 needs at least -12.5 dB SNR
-    -15,  // SF10 needs at least -15 dB SNR
-    -17.5,// SF11 needs at least -17.5 dB SNR
-    -20   // SF12 needs at least -20 dB SNR
-};
-  
-float RadioLibWrapper::packetScoreInt(float snr, int sf, int packet_len) {
-  if (sf < 7) return 0.0f;
-  
-  if (snr < snr_threshold[sf - 7]) return 0.0f;    // Below threshold, no chance of success
-
-  auto success_rate_based_on_snr = (snr - snr_threshold[sf - 7]) / 10.0;
-  auto collision_penalty = 1 - (packet_len / 256.0);   // Assuming max packet of 256 bytes
-
-  return max(0.0, min(1.0, success_rate_based_on_snr * collision_penalty));
-}
@@ -2,6 +2,9 @@
 
 #include <Mesh.h>
 #include <RadioLib.h>
+#include <helpers/PacketScorer.h>
+
+#define AIRTIME_TABLE_SIZE   256   // every possible raw packet length
 
 class RadioLibWrapper : public mesh::Radio {
 protected:
@@ -11,18 +14,49 @@ protected:
   int16_t _noise_floor, _threshold;
   uint16_t _num_floor_samples;
   int32_t _floor_sample_sum;
+  uint32_t _airtime[AIRTIME_TABLE_SIZE];   // est. airtime (millis) by packet length, for radio params below
+  uint8_t _table_sf, _table_cr;            // radio params _airtime[] and packet scorer were set up for
+  float _table_bw;
+  SNRPacketScorer _default_scorer;
+  PacketScorer* _scorer;
 
   void idle();
   void startRecv();
-  float packetScoreInt(float snr, int sf, int packet_len);
   virtual bool isReceivingPacket() =0;
+  void checkParamsChanged();
+
+  // current radio params, for packet scorer (drivers which can't report these fall back to build defaults)
+  virtual uint8_t getSpreadingFactor() const {
+  #ifdef LORA_SF
+    return LORA_SF;
+  #else
+    return 10;
+  #endif
+  }
+  virtual float getBandwidth() const {
+  #ifdef LORA_BW
+    return LORA_BW;
+  #else
+    return 250.0f;
+  #endif
+  }
+  virtual uint8_t getCodingRate() const { return 0; }   // driver's raw value, 0 = can't report (so no airtime table)
 
 public:
-  RadioLibWrapper(PhysicalLayer& radio, mesh::MainBoard& board) : _radio(&radio), _board(&board) { n_recv = n_sent = 0; }
+  RadioLibWrapper(PhysicalLayer& radio, mesh::MainBoard& board) : _radio(&radio), _board(&board) {
+    n_recv = n_sent = 0; _scorer = &_default_scorer;
+    _table_sf = _table_cr = 0; _table_bw = 0;
+  }
 
   void begin() override;
   int recvRaw(uint8_t* bytes, int sz) override;
   uint32_t getEstAirtimeFor(int len_bytes) override;
+
+  /**
+   * \brief  replace the default (SNR based) packet scoring strategy
+   */
+  void setPacketScorer(PacketScorer* scorer);
+
   bool startSendRaw(const uint8_t* bytes, int len) override;
   bool isSendComplete() override;
   void onSendFinished() override;
@@ -50,7 +84,8 @@ public:
   virtual float getLastRSSI() const override;
   virtual float getLastSNR() const override;
 
-  float packetScore(float snr, int packet_len) override { return packetScoreInt(snr, 10, packet_len); }  // assume sf=10
+  float packetScore(float snr, int packet_len) override { checkParamsChanged(); return _scorer->score(snr, packet_len); }
+  float getSNRFloor() override { return SNRPacketScorer::getSNRFloor(getSpreadingFactor()); }
 };
 
 /**
@@ -323,161 +323,350 @@ bool EnvironmentSensorManager::begin() {
   }
   #endif
 
+  initCache();
   return true;
 }
 
-bool EnvironmentSensorManager::querySensors(uint8_t requester_permissions, CayenneLPP& telemetry) {
-  next_available_channel = TELEM_CHANNEL_SELF + 1;
+bool EnvironmentSensorManager::isSensorPresent(int sensor) const {
+  switch (sensor) {
+    case ENV_SENSOR_AHTX0:    return AHTX0_initialized;
+    case ENV_SENSOR_BME280:   return BME280_initialized;
+    case ENV_SENSOR_BMP280:   return BMP280_initialized;
+    case ENV_SENSOR_SHTC3:    return SHTC3_initialized;
+    case ENV_SENSOR_SHT4X:    return SHT4X_initialized;
+    case ENV_SENSOR_LPS22HB:  return LPS22HB_initialized;
+    case ENV_SENSOR_INA3221:  return INA3221_initialized;
+    case ENV_SENSOR_INA219:   return INA219_initialized;
+    case ENV_SENSOR_INA260:   return INA260_initialized;
+    case ENV_SENSOR_INA226:   return INA226_initialized;
+    case ENV_SENSOR_MLX90614: return MLX90614_initialized;
+    case ENV_SENSOR_VL53L0X:  return VL53L0X_initialized;
+    case ENV_SENSOR_BME680:   return BME680_initialized;
+    case ENV_SENSOR_BMP085:   return BMP085_initialized;
+  }
+  return false;
+}
 
-  if (requester_permissions & TELEM_PERM_LOCATION && gps_active) {
-    telemetry.addGPS(TELEM_CHANNEL_SELF, node_lat, node_lon, node_altitude); // allow lat/lon via telemetry even if no GPS is detected
+void EnvironmentSensorManager::initCache() {
+  // allocate the extra LPP channels once, so readings keep same channel regardless of which sensor is refreshed
+  int channel = TELEM_CHANNEL_SELF + 1;
+  num_cached = 0;
+  sampling = false;
+  clearSchedule();
+  #if ENV_INCLUDE_GPS
+  gps_schedule = addSchedule(ENV_GPS_UPDATE_MILLIS, 0);
+  #endif
+  for (int s = 0; s < ENV_NUM_SENSORS; s++) {
+    sensor_channel[s] = channel;
+    sensor_cached[s] = false;
+    sensor_max_age[s] = 0;   // not present
+    sensor_schedule[s] = -1;
+    if (!isSensorPresent(s)) continue;
+
+    switch (s) {
+      case ENV_SENSOR_INA3221:
+      #if ENV_INCLUDE_INA3221
+        for (int i = 0; i < TELEM_INA3221_NUM_CHANNELS; i++) {
+          if (INA3221.isChannelEnabled(i)) channel++;
+        }
+      #endif
+        sensor_max_age[s] = ENV_POWER_MAX_AGE_MILLIS;
+        break;
+      case ENV_SENSOR_INA219:
+      case ENV_SENSOR_INA260:
+      case ENV_SENSOR_INA226:
+        channel++;
+        sensor_max_age[s] = ENV_POWER_MAX_AGE_MILLIS;
+        break;
+      case ENV_SENSOR_VL53L0X:
+        sensor_max_age[s] = ENV_DISTANCE_MAX_AGE_MILLIS;
+        break;
+      case ENV_SENSOR_BME680:
+        channel++;   // gas resistance
+        sensor_max_age[s] = ENV_CLIMATE_MAX_AGE_MILLIS;
+        break;
+      default:
+        sensor_max_age[s] = ENV_CLIMATE_MAX_AGE_MILLIS;
+        break;
+    }
+    sensor_schedule[s] = addSchedule(sensor_max_age[s], getSensorCost(s), false);   // paused, until first query
   }
+}
 
-  if (requester_permissions & TELEM_PERM_ENVIRONMENT) {
+uint16_t EnvironmentSensorManager::getSensorCost(int sensor) const {
+  // rough bus time (millis) of one reading, incl. conversion time
+  switch (sensor) {
+    case ENV_SENSOR_AHTX0:    return 80;
+    case ENV_SENSOR_SHTC3:    return 15;
+    case ENV_SENSOR_SHT4X:    return 5;
+    case ENV_SENSOR_VL53L0X:  return 35;
+    case ENV_SENSOR_BME680:   return 200;   // gas heater
+    case ENV_SENSOR_BMP085:   return 30;
+    case ENV_SENSOR_INA3221:
+    case ENV_SENSOR_INA219:
+    case ENV_SENSOR_INA260:
+    case ENV_SENSOR_INA226:
+    case ENV_SENSOR_MLX90614: return 2;
+  }
+  return 5;
+}
 
+bool EnvironmentSensorManager::sampleSensor(int id) {
+  #if ENV_INCLUDE_GPS
+  if (id == gps_schedule) {
+    updateGPSPosition();
+    return false;   // (not a reading, for alerts)
+  }
+  #endif
+  for (int s = 0; s < ENV_NUM_SENSORS; s++) {
+    if (sensor_schedule[s] == id) {
+      refreshSensor(s);
+      return true;
+    }
+  }
+  return false;
+}
+
+void EnvironmentSensorManager::setSensorMaxAge(int sensor, uint32_t max_age_millis) {
+  if (sensor >= 0 && sensor < ENV_NUM_SENSORS && isSensorPresent(sensor) && max_age_millis > 0) {
+    sensor_max_age[sensor] = max_age_millis;
+    setSchedulePeriod(sensor_schedule[sensor], max_age_millis);
+  }
+}
+
+static void putReading(EnvReading dest[], int& n, uint8_t channel, uint8_t lpp_type, float value) {
+  if (n >= ENV_MAX_SENSOR_READINGS) return;
+  dest[n].channel = channel;
+  dest[n].lpp_type = lpp_type;
+  dest[n].value = value;
+  n++;
+}
+
+int EnvironmentSensorManager::readSensor(int sensor, EnvReading dest[]) {
+  int n = 0;
+  uint8_t channel = sensor_channel[sensor];
+
+  switch (sensor) {
     #if ENV_INCLUDE_AHTX0
-    if (AHTX0_initialized) {
+    case ENV_SENSOR_AHTX0: {
       sensors_event_t humidity, temp;
       AHTX0.getEvent(&humidity, &temp);
-      telemetry.addTemperature(TELEM_CHANNEL_SELF, temp.temperature);
-      telemetry.addRelativeHumidity(TELEM_CHANNEL_SELF, humidity.relative_humidity);
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_TEMPERATURE, temp.temperature);
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_RELATIVE_HUMIDITY, humidity.relative_humidity);
+      break;
     }
     #endif
 
     #if ENV_INCLUDE_BME280
-    if (BME280_initialized) {
-      telemetry.addTemperature(TELEM_CHANNEL_SELF, BME280.readTemperature());
-      telemetry.addRelativeHumidity(TELEM_CHANNEL_SELF, BME280.readHumidity());
-      telemetry.addBarometricPressure(TELEM_CHANNEL_SELF, BME280.readPressure()/100);
-      telemetry.addAltitude(TELEM_CHANNEL_SELF, BME280.readAltitude(TELEM_BME280_SEALEVELPRESSURE_HPA));
-    }
+    case ENV_SENSOR_BME280:
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_TEMPERATURE, BME280.readTemperature());
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_RELATIVE_HUMIDITY, BME280.readHumidity());
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_BAROMETRIC_PRESSURE, BME280.readPressure()/100);
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_ALTITUDE, BME280.readAltitude(TELEM_BME280_SEALEVELPRESSURE_HPA));
+      break;
     #endif
 
     #if ENV_INCLUDE_BMP280
-    if (BMP280_initialized) {
-      telemetry.addTemperature(TELEM_CHANNEL_SELF, BMP280.readTemperature());
-      telemetry.addBarometricPressure(TELEM_CHANNEL_SELF, BMP280.readPressure()/100);
-      telemetry.addAltitude(TELEM_CHANNEL_SELF, BMP280.readAltitude(TELEM_BMP280_SEALEVELPRESSURE_HPA));
-    }
+    case ENV_SENSOR_BMP280:
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_TEMPERATURE, BMP280.readTemperature());
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_BAROMETRIC_PRESSURE, BMP280.readPressure()/100);
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_ALTITUDE, BMP280.readAltitude(TELEM_BMP280_SEALEVELPRESSURE_HPA));
+      break;
     #endif
 
     #if ENV_INCLUDE_SHTC3
-    if (SHTC3_initialized) {
+    case ENV_SENSOR_SHTC3: {
       sensors_event_t humidity, temp;
       SHTC3.getEvent(&humidity, &temp);
 
-      telemetry.addTemperature(TELEM_CHANNEL_SELF, temp.temperature);
-      telemetry.addRelativeHumidity(TELEM_CHANNEL_SELF, humidity.relative_humidity);
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_TEMPERATURE, temp.temperature);
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_RELATIVE_HUMIDITY, humidity.relative_humidity);
+      break;
     }
     #endif
 
     #if ENV_INCLUDE_SHT4X
-    if (SHT4X_initialized) {
+    case ENV_SENSOR_SHT4X: {
       float sht4x_humidity, sht4x_temperature;
       int16_t sht4x_error;
       sht4x_error = SHT4X.measureLowestPrecision(sht4x_temperature, sht4x_humidity);
       if (sht4x_error == 0) {
-        telemetry.addTemperature(TELEM_CHANNEL_SELF, sht4x_temperature);
-        telemetry.addRelativeHumidity(TELEM_CHANNEL_SELF, sht4x_humidity);
+        putReading(dest, n, TELEM_CHANNEL_SELF, LPP_TEMPERATURE, sht4x_temperature);
+        putReading(dest, n, TELEM_CHANNEL_SELF, LPP_RELATIVE_HUMIDITY, sht4x_humidity);
       }
+      break;
     }
     #endif
 
     #if ENV_INCLUDE_LPS22HB
-    if (LPS22HB_initialized) {
-      telemetry.addTemperature(TELEM_CHANNEL_SELF, BARO.readTemperature());
-      telemetry.addBarometricPressure(TELEM_CHANNEL_SELF, BARO.readPressure());
-    }
+    case ENV_SENSOR_LPS22HB:
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_TEMPERATURE, BARO.readTemperature());
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_BAROMETRIC_PRESSURE, BARO.readPressure());
+      break;
     #endif
 
     #if ENV_INCLUDE_INA3221
-    if (INA3221_initialized) {
+    case ENV_SENSOR_INA3221:
       for(int i = 0; i < TELEM_INA3221_NUM_CHANNELS; i++) {
         // add only enabled INA3221 channels to telemetry
         if (INA3221.isChannelEnabled(i)) {
           float voltage = INA3221.getBusVoltage(i);
           float current = INA3221.getCurrentAmps(i);
-          telemetry.addVoltage(next_available_channel, voltage);
-          telemetry.addCurrent(next_available_channel, current);
-          telemetry.addPower(next_available_channel, voltage * current);
-          next_available_channel++;
+          putReading(dest, n, channel, LPP_VOLTAGE, voltage);
+          putReading(dest, n, channel, LPP_CURRENT, current);
+          putReading(dest, n, channel, LPP_POWER, voltage * current);
+          channel++;
         }
       }
-    }
+      break;
     #endif
 
     #if ENV_INCLUDE_INA219
-    if (INA219_initialized) {
-      telemetry.addVoltage(next_available_channel, INA219.getBusVoltage_V());
-      telemetry.addCurrent(next_available_channel, INA219.getCurrent_mA() / 1000);
-      telemetry.addPower(next_available_channel, INA219.getPower_mW() / 1000);
-      next_available_channel++;
-    }
+    case ENV_SENSOR_INA219:
+      putReading(dest, n, channel, LPP_VOLTAGE, INA219.getBusVoltage_V());
+      putReading(dest, n, channel, LPP_CURRENT, INA219.getCurrent_mA() / 1000);
+      putReading(dest, n, channel, LPP_POWER, INA219.getPower_mW() / 1000);
+      break;
     #endif
 
     #if ENV_INCLUDE_INA260
-    if (INA260_initialized) {
-      telemetry.addVoltage(next_available_channel, INA260.readBusVoltage() / 1000);
-      telemetry.addCurrent(next_available_channel, INA260.readCurrent() / 1000);
-      telemetry.addPower(next_available_channel, INA260.readPower() / 1000);
-      next_available_channel++;
-    }
+    case ENV_SENSOR_INA260:
+      putReading(dest, n, channel, LPP_VOLTAGE, INA260.readBusVoltage() / 1000);
+      putReading(dest, n, channel, LPP_CURRENT, INA260.readCurrent() / 1000);
+      putReading(dest, n, channel, LPP_POWER, INA260.readPower() / 1000);
+      break;
     #endif
 
     #if ENV_INCLUDE_INA226
-    if (INA226_initialized) {
-      telemetry.addVoltage(next_available_channel, INA226.getBusVoltage());
-      telemetry.addCurrent(next_available_channel, INA226.getCurrent_mA() / 1000.0);
-      telemetry.addPower(next_available_channel, INA226.getPower_mW() / 1000.0);
-      next_available_channel++;
-    }
+    case ENV_SENSOR_INA226:
+      putReading(dest, n, channel, LPP_VOLTAGE, INA226.getBusVoltage());
+      putReading(dest, n, channel, LPP_CURRENT, INA226.getCurrent_mA() / 1000.0);
+      putReading(dest, n, channel, LPP_POWER, INA226.getPower_mW() / 1000.0);
+      break;
     #endif
 
     #if ENV_INCLUDE_MLX90614
-    if (MLX90614_initialized) {
-      telemetry.addTemperature(TELEM_CHANNEL_SELF, MLX90614.readObjectTempC());
-      telemetry.addTemperature(TELEM_CHANNEL_SELF + 1, MLX90614.readAmbientTempC());
-    }
+    case ENV_SENSOR_MLX90614:
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_TEMPERATURE, MLX90614.readObjectTempC());
+      putReading(dest, n, TELEM_CHANNEL_SELF + 1, LPP_TEMPERATURE, MLX90614.readAmbientTempC());
+      break;
     #endif
 
     #if ENV_INCLUDE_VL53L0X
-    if (VL53L0X_initialized) {
+    case ENV_SENSOR_VL53L0X: {
       VL53L0X_RangingMeasurementData_t measure;
       VL53L0X.rangingTest(&measure, false); // pass in 'true' to get debug data
       if (measure.RangeStatus != 4) { // phase failures
-        telemetry.addDistance(TELEM_CHANNEL_SELF, measure.RangeMilliMeter / 1000.0f); // convert mm to m
+        putReading(dest, n, TELEM_CHANNEL_SELF, LPP_DISTANCE, measure.RangeMilliMeter / 1000.0f); // convert mm to m
       } else {
-        telemetry.addDistance(TELEM_CHANNEL_SELF, 0.0f); // no valid measurement
+        putReading(dest, n, TELEM_CHANNEL_SELF, LPP_DISTANCE, 0.0f); // no valid measurement
       }
+      break;
     }
     #endif
 
     #if ENV_INCLUDE_BME680
-    if (BME680_initialized) {
+    case ENV_SENSOR_BME680:
       if (BME680.performReading()) {
-        telemetry.addTemperature(TELEM_CHANNEL_SELF, BME680.temperature);
-        telemetry.addRelativeHumidity(TELEM_CHANNEL_SELF, BME680.humidity);
-        telemetry.addBarometricPressure(TELEM_CHANNEL_SELF, BME680.pressure / 100);
-        telemetry.addAltitude(TELEM_CHANNEL_SELF, 44330.0 * (1.0 - pow((BME680.pressure / 100) / TELEM_BME680_SEALEVELPRESSURE_HPA, 0.1903)));
-        telemetry.addAnalogInput(next_available_channel, BME680.gas_resistance);
-        next_available_channel++;
+        putReading(dest, n, TELEM_CHANNEL_SELF, LPP_TEMPERATURE, BME680.temperature);
+        putReading(dest, n, TELEM_CHANNEL_SELF, LPP_RELATIVE_HUMIDITY, BME680.humidity);
+        putReading(dest, n, TELEM_CHANNEL_SELF, LPP_BAROMETRIC_PRESSURE, BME680.pressure / 100);
+        putReading(dest, n, TELEM_CHANNEL_SELF, LPP_ALTITUDE, 44330.0 * (1.0 - pow((BME680.pressure / 100) / TELEM_BME680_SEALEVELPRESSURE_HPA, 0.1903)));
+        putReading(dest, n, channel, LPP_ANALOG_INPUT, BME680.gas_resistance);
       }
-    }
+      break;
     #endif
 
     #if ENV_INCLUDE_BMP085
-    if (BMP085_initialized) {
-        telemetry.addTemperature(TELEM_CHANNEL_SELF, BMP085.readTemperature());
-        telemetry.addBarometricPressure(TELEM_CHANNEL_SELF, BMP085.readPressure() / 100);
-        telemetry.addAltitude(TELEM_CHANNEL_SELF, BMP085.readAltitude(TELEM_BMP085_SEALEVELPRESSURE_HPA * 100));
-    }
+    case ENV_SENSOR_BMP085:
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_TEMPERATURE, BMP085.readTemperature());
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_BAROMETRIC_PRESSURE, BMP085.readPressure() / 100);
+      putReading(dest, n, TELEM_CHANNEL_SELF, LPP_ALTITUDE, BMP085.readAltitude(TELEM_BMP085_SEALEVELPRESSURE_HPA * 100));
+      break;
     #endif
+  }
+  return n;
+}
+
+void EnvironmentSensorManager::refreshSensor(int sensor) {
+  EnvReading fresh[ENV_MAX_SENSOR_READINGS];
+  int n = readSensor(sensor, fresh);
 
+  // replace this sensor's readings, keeping cache in sensor order (same order as telemetry was always built)
+  int start = 0;
+  while (start < num_cached && cached[start].sensor < sensor) start++;
+  int end = start;
+  while (end < num_cached && cached[end].sensor == sensor) end++;
+
+  if (num_cached - (end - start) + n > ENV_MAX_CACHED_READINGS) {
+    MESH_DEBUG_PRINTLN("EnvironmentSensorManager: reading cache full, sensor %d dropped", sensor);
+    n = 0;
+  }
+  memmove(&cached[start + n], &cached[end], (num_cached - end) * sizeof(EnvReading));
+  num_cached += n - (end - start);
+  for (int i = 0; i < n; i++) {
+    cached[start + i] = fresh[i];
+    cached[start + i].sensor = sensor;
+  }
+
+  sensor_cached[sensor] = true;
+}
+
+static void addReading(CayenneLPP& telemetry, const EnvReading& r) {
+  switch (r.lpp_type) {
+    case LPP_TEMPERATURE:         telemetry.addTemperature(r.channel, r.value); break;
+    case LPP_RELATIVE_HUMIDITY:   telemetry.addRelativeHumidity(r.channel, r.value); break;
+    case LPP_BAROMETRIC_PRESSURE: telemetry.addBarometricPressure(r.channel, r.value); break;
+    case LPP_ALTITUDE:            telemetry.addAltitude(r.channel, r.value); break;
+    case LPP_VOLTAGE:             telemetry.addVoltage(r.channel, r.value); break;
+    case LPP_CURRENT:             telemetry.addCurrent(r.channel, r.value); break;
+    case LPP_POWER:               telemetry.addPower(r.channel, r.value); break;
+    case LPP_ANALOG_INPUT:        telemetry.addAnalogInput(r.channel, r.value); break;
+    case LPP_DISTANCE:            telemetry.addDistance(r.channel, r.value); break;
+  }
+}
+
+bool EnvironmentSensorManager::querySensors(uint8_t requester_permissions, CayenneLPP& telemetry) {
+  if (requester_permissions & TELEM_PERM_LOCATION && gps_active) {
+    telemetry.addGPS(TELEM_CHANNEL_SELF, node_lat, node_lon, node_altitude); // allow lat/lon via telemetry even if no GPS is detected
+  }
+
+  if (requester_permissions & TELEM_PERM_ENVIRONMENT) {
+    // readings are refreshed by schedule from loop(), only touch the bus here for sensors not sampled yet
+    last_query = millis();
+    if (!sampling) setSampling(true);
+    for (int s = 0; s < ENV_NUM_SENSORS; s++) {
+      if (sensor_max_age[s] && !sensor_cached[s]) refreshSensor(s);
+    }
+    for (int i = 0; i < num_cached; i++) {
+      addReading(telemetry, cached[i]);
+    }
   }
 
   return true;
 }
 
+void EnvironmentSensorManager::loop() {
+  #if ENV_INCLUDE_GPS
+  _location->loop();
+  #endif
+
+  if (sampling && millis() - last_query > ENV_SAMPLING_IDLE_MILLIS) {
+    setSampling(false);   // nobody is asking, so don't keep the bus (and eg. BME680 heater) busy
+  }
+  runSchedule();
+}
+
+void EnvironmentSensorManager::setSampling(bool on) {
+  MESH_DEBUG_PRINTLN("EnvironmentSensorManager: scheduled sampling %s", on ? "on" : "off");
+  sampling = on;
+  for (int s = 0; s < ENV_NUM_SENSORS; s++) {
+    if (sensor_schedule[s] < 0) continue;
+    if (on) sensor_cached[s] = false;   // readings may be stale, so caller re-reads them now
+    setScheduleActive(sensor_schedule[s], on);
+  }
+}
+
 
 int EnvironmentSensorManager::getNumSettings() const {
   int settings = 0;
@@ -678,34 +867,19 @@ void EnvironmentSensorManager::stop_gps() {
   #endif
 }
 
-void EnvironmentSensorManager::loop() {
-  static long next_gps_update = 0;
-
-  #if ENV_INCLUDE_GPS
-  _location->loop();
+void EnvironmentSensorManager::updateGPSPosition() {
+  if (!gps_active) return;
 
-  if (millis() > next_gps_update) {
-    if(gps_active){
-    #ifdef RAK_WISBLOCK_GPS
-    if ((i2cGPSFlag || serialGPSFlag) && _location->isValid()) {
-      node_lat = ((double)_location->getLatitude())/1000000.;
-      node_lon = ((double)_location->getLongitude())/1000000.;
-      MESH_DEBUG_PRINTLN("lat %f lon %f", node_lat, node_lon);
-      node_altitude = ((double)_location->getAltitude()) / 1000.0;
-      MESH_DEBUG_PRINTLN("lat %f lon %f alt %f", node_lat, node_lon, node_altitude);
-    }
-    #else
-    if (_location->isValid()) {
-      node_lat = ((double)_location->getLatitude())/1000000.;
-      node_lon = ((double)_location->getLongitude())/1000000.;
-      MESH_DEBUG_PRINTLN("lat %f lon %f", node_lat, node_lon);
-      node_altitude = ((double)_location->getAltitude()) / 1000.0;
-      MESH_DEBUG_PRINTLN("lat %f lon %f alt %f", node_lat, node_lon, node_altitude);
-    }
-    #endif
-    }
-    next_gps_update = millis() + 1000;
+#ifdef RAK_WISBLOCK_GPS
+  if ((i2cGPSFlag || serialGPSFlag) && _location->isValid()) {
+#else
+  if (_location->isValid()) {
+#endif
+    node_lat = ((double)_location->getLatitude())/1000000.;
+    node_lon = ((double)_location->getLongitude())/1000000.;
+    MESH_DEBUG_PRINTLN("lat %f lon %f", node_lat, node_lon);
+    node_altitude = ((double)_location->getAltitude()) / 1000.0;
+    MESH_DEBUG_PRINTLN("lat %f lon %f alt %f", node_lat, node_lon, node_altitude);
   }
-  #endif
 }
 #endif
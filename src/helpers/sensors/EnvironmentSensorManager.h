@@ -4,9 +4,71 @@
 #include <helpers/SensorManager.h>
 #include <helpers/sensors/LocationProvider.h>
 
+// sensors, in the order their readings appear in telemetry
+#define ENV_SENSOR_AHTX0      0
+#define ENV_SENSOR_BME280     1
+#define ENV_SENSOR_BMP280     2
+#define ENV_SENSOR_SHTC3      3
+#define ENV_SENSOR_SHT4X      4
+#define ENV_SENSOR_LPS22HB    5
+#define ENV_SENSOR_INA3221    6
+#define ENV_SENSOR_INA219     7
+#define ENV_SENSOR_INA260     8
+#define ENV_SENSOR_INA226     9
+#define ENV_SENSOR_MLX90614  10
+#define ENV_SENSOR_VL53L0X   11
+#define ENV_SENSOR_BME680    12
+#define ENV_SENSOR_BMP085    13
+#define ENV_NUM_SENSORS      14
+
+// default max age of cached readings, before loop() re-samples the sensor
+#ifndef ENV_CLIMATE_MAX_AGE_MILLIS
+  #define ENV_CLIMATE_MAX_AGE_MILLIS   60000   // temperature, humidity, pressure
+#endif
+#ifndef ENV_POWER_MAX_AGE_MILLIS
+  #define ENV_POWER_MAX_AGE_MILLIS     10000   // INA voltage/current monitors
+#endif
+#ifndef ENV_DISTANCE_MAX_AGE_MILLIS
+  #define ENV_DISTANCE_MAX_AGE_MILLIS   5000
+#endif
+#ifndef ENV_SAMPLING_IDLE_MILLIS
+  #define ENV_SAMPLING_IDLE_MILLIS   (15*60*1000UL)   // pause scheduled sampling after no queries for this long
+#endif
+#ifndef ENV_GPS_UPDATE_MILLIS
+  #define ENV_GPS_UPDATE_MILLIS   1000   // copy GPS fix to node_lat/lon
+#endif
+
+#ifndef ENV_MAX_CACHED_READINGS
+  #define ENV_MAX_CACHED_READINGS   24
+#endif
+#define ENV_MAX_SENSOR_READINGS      9     // most from any one sensor (INA3221, 3 channels)
+
+struct EnvReading {
+  uint8_t sensor;
+  uint8_t channel;
+  uint8_t lpp_type;
+  float value;
+};
+
 class EnvironmentSensorManager : public SensorManager {
 protected:
-  int next_available_channel = TELEM_CHANNEL_SELF + 1;
+  // last readings of each sensor, so telemetry requests don't need any I2C transactions
+  EnvReading cached[ENV_MAX_CACHED_READINGS];
+  int num_cached = 0;
+  uint8_t sensor_channel[ENV_NUM_SENSORS];   // first LPP channel allocated to sensor
+  bool sensor_cached[ENV_NUM_SENSORS] = {};
+  uint32_t sensor_max_age[ENV_NUM_SENSORS] = {};  // zero if sensor not present
+  int sensor_schedule[ENV_NUM_SENSORS];
+  bool sampling = false;          // sensors are only sampled by schedule while their readings are being queried
+  unsigned long last_query = 0;   // millis
+
+  bool isSensorPresent(int sensor) const;
+  void initCache();
+  int readSensor(int sensor, EnvReading dest[]);
+  void refreshSensor(int sensor);
+  void setSampling(bool on);
+  uint16_t getSensorCost(int sensor) const;
+  bool sampleSensor(int id) override;
 
   bool AHTX0_initialized = false;
   bool BME280_initialized = false;
@@ -28,6 +90,8 @@ protected:
 
   #if ENV_INCLUDE_GPS
   LocationProvider* _location;
+  int gps_schedule = -1;
+  void updateGPSPosition();
   void start_gps();
   void stop_gps();
   void initBasicGPS();
@@ -47,9 +111,8 @@ public:
   #endif
   bool begin() override;
   bool querySensors(uint8_t requester_permissions, CayenneLPP& telemetry) override;
-  #if ENV_INCLUDE_GPS
   void loop() override;
-  #endif
+  void setSensorMaxAge(int sensor, uint32_t max_age_millis);
   int getNumSettings() const override;
   const char* getSettingName(int i) const override;
   const char* getSettingValue(int i) const override;